@@ -31,6 +31,7 @@
 //| had knowledge of the CeCILL license and that you accept its terms.
 
 //#define SHOW_TIMER
+#include <sstream>
 #include <limbo/limbo.hpp>
 #include <limbo/inner_cmaes.hpp>
 #include "exhaustiveSearchMap.hpp"
@@ -80,12 +81,20 @@ struct Params {
             std::vector<float> controller;
         };
 
+        // archive rows are: cell index, desc_dim coordinates, fitness,
+        // nb_params controller parameters (gen::EvoFloat<20> in gatest)
+        BOOST_STATIC_CONSTEXPR int nb_params = 20;
+        // dimension of the behaviour descriptor of the map, read from the
+        // width of the rows by load_archive (4 for gatest: the duty
+        // factors; 19 for gatest_cvt: duty factors and rotation histograms)
+        static int desc_dim;
+
         struct classcomp {
             bool operator()(const std::vector<float>& lhs, const std::vector<float>& rhs) const
             {
-                assert(lhs.size() == 2 && rhs.size() == 2);
-                int i = 0;
-                while (i < 1 && round(lhs[i] * 40) == round(rhs[i] * 40)) //lhs[i]==rhs[i])
+                assert(lhs.size() == rhs.size() && !lhs.empty());
+                size_t i = 0;
+                while (i < lhs.size() - 1 && round(lhs[i] * 40) == round(rhs[i] * 40)) //lhs[i]==rhs[i])
                     i++;
                 return round(lhs[i] * 40) < round(rhs[i] * 40); //lhs[i]<rhs[i];
             }
@@ -114,7 +123,8 @@ namespace global {
 template <typename Params>
 struct fit_eval_map {
 
-    BOOST_STATIC_CONSTEXPR int dim = 2;
+    // known once the archive is loaded
+    static const int& dim;
     fit_eval_map()
     {
         timerclear(&global::timev_selection);
@@ -152,49 +162,63 @@ struct fit_eval_map {
     }
 };
 
+template <typename Params>
+const int& fit_eval_map<Params>::dim = Params::archiveparams::desc_dim;
+
+// sets Params::archiveparams::desc_dim; an empty archive means an error
 std::map<std::vector<float>, Params::archiveparams::elem_archive, Params::archiveparams::classcomp>
 load_archive(std::string archive_name){
 
     std::map<std::vector<float>, Params::archiveparams::elem_archive, Params::archiveparams::classcomp> archive;
 
     std::ifstream monFlux(archive_name.c_str()); //Ouverture d'un fichier en lecture
-    if (monFlux) {
-        while (!monFlux.eof()) {
-            Params::archiveparams::elem_archive elem;
-            std::vector<float> candidate(2);
-            //std::cout << "Data: ";
-            for (int i = 0; i < 23; i++) { //43 is amount of elements in columns
-                if (monFlux.eof())
-                    break;
-                float data;
-                monFlux >> data;
-                // std::cout << data << " ";
-                if (i == 1 || i == 2){
-                    candidate[i-1] = data; //I on the other hand have duplicated the candidate data
-                }
-                if (i == 3) {
-                    elem.fit = data;
-                }
-                if (i >= 4)
-                    elem.params.push_back(data);
-            }
-            //std::cout << " |Size| " << candidate << std::endl;
-            if (elem.params.size() == 19) {
-               //    std::cout << "Candidate: " << candidate.at(0) << " " << candidate.at(1) << " : " << elem.fit << std::endl;
-                archive[candidate] = elem;
-            }
-        }
-    }
-    else {
+    if (!monFlux) {
         std::cout << "ERREUR: Impossible d'ouvrir le fichier en lecture." << std::endl;
         return archive;
     }
+    const int nb_params = Params::archiveparams::nb_params;
+    int desc_dim = 0;
+    size_t nb_rows = 0;
+    std::string line;
+    while (std::getline(monFlux, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream row(line);
+        std::vector<float> data;
+        float d;
+        while (row >> d)
+            data.push_back(d);
+        // cell index, descriptor, fitness, parameters: the width of the
+        // first row gives the dimension of the descriptor, and every row
+        // must have the same width
+        int dim = int(data.size()) - 2 - nb_params;
+        if (desc_dim == 0)
+            desc_dim = dim;
+        if (dim < 1 || dim != desc_dim) {
+            std::cerr << "ERROR: " << archive_name << ": row " << nb_rows + 1 << " has "
+                      << data.size() << " columns, expected "
+                      << (desc_dim > 0 ? std::to_string(desc_dim + 2 + nb_params) : "at least " + std::to_string(3 + nb_params))
+                      << " (cell index, descriptor, fitness and "
+                      << nb_params << " controller parameters)" << std::endl;
+            return Params::archiveparams::archive_t();
+        }
+        Params::archiveparams::elem_archive elem;
+        std::vector<float> candidate(data.begin() + 1, data.begin() + 1 + desc_dim);
+        elem.fit = data[desc_dim + 1];
+        elem.params.assign(data.begin() + desc_dim + 2, data.end());
+        archive[candidate] = elem;
+        ++nb_rows;
+    }
+    Params::archiveparams::desc_dim = desc_dim;
+    std::cout << desc_dim << "-D descriptors, ";
+    std::cout << nb_rows << " rows read" << std::endl;
     std::cout << archive.size() << " elements loaded" << std::endl;
     return archive;
 }
 
 
 Params::archiveparams::archive_t Params::archiveparams::archive;
+int Params::archiveparams::desc_dim = 0;
 BO_DECLARE_DYN_PARAM(float, Params::kf_maternfivehalfs, l);
 BO_DECLARE_DYN_PARAM(int, Params::maxiterations, n_iterations);
 BO_DECLARE_DYN_PARAM(float, Params::ucb, alpha);
@@ -207,6 +231,10 @@ int main(int argc, char** argv)
         return -1;
     }
     Params::archiveparams::archive = load_archive(argv[1]);
+    if (Params::archiveparams::archive.empty()) {
+        std::cout << "no archive loaded" << std::endl;
+        return -1;
+    }
 
     if (argc > 2)
         Params::kf_maternfivehalfs::set_l(atof(argv[2]));
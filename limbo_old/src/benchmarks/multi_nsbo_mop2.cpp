@@ -28,7 +28,7 @@ struct Params {
   struct cmaes : public defaults::cmaes {};
   struct gp_auto : public defaults::gp_auto {};
   struct meanconstant : public defaults::meanconstant {};
-  struct ehvi {
+  struct ehvi : public defaults::ehvi {
     BO_PARAM(double, x_ref, -11);
     BO_PARAM(double, y_ref, -11);
   };
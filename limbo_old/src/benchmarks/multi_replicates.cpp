@@ -0,0 +1,182 @@
+#include <fstream>
+#include <functional>
+#include "limbo/limbo.hpp"
+#include "limbo/parego.hpp"
+#include "limbo/ehvi.hpp"
+#include "limbo/nsbo.hpp"
+
+// Runs nb_replicates replicates of {ParEGO, NSBO, EHVI} x {ZDT2 (2 and 6
+// dimensions), MOP2} in a single process, all the replicates being
+// scheduled together by par::loop, and writes one line per replicate
+// in a single file:
+//   multi_replicates [nb_replicates=10] [file=replicates.dat] [seed=0]
+// Replicate k of a pair (algorithm, problem) has its own generator,
+// seeded with seed + k, so that the pairs start from the same initial
+// samples. Each replicate runs on a single thread (par::serial) with its
+// generator installed (misc::ScopedGenerator) for limbo and for the
+// NSGA-II of BoMulti::update_pareto_model (sferes), so that a file can be
+// replayed exactly whatever the number of threads.
+
+using namespace limbo;
+
+struct Params {
+  struct boptimizer {
+    BO_PARAM(double, noise, 0.01);
+    BO_PARAM(int, dump_period, -1);
+  };
+  struct init {
+    BO_PARAM(int, nb_samples, 10);
+  };
+  struct parego : public defaults::parego {};
+  struct maxiterations {
+    BO_PARAM(int, n_iterations, 30);
+  };
+  struct ucb : public defaults::ucb {};
+  struct gp_ucb : public defaults::gp_ucb {};
+  struct cmaes : public defaults::cmaes {};
+  struct gp_auto : public defaults::gp_auto {};
+  struct meanconstant : public defaults::meanconstant {};
+  struct ehvi : public defaults::ehvi {
+    BO_PARAM(double, x_ref, -11);
+    BO_PARAM(double, y_ref, -11);
+  };
+};
+
+template<int D>
+struct zdt2 {
+  static constexpr size_t dim = D;
+  Eigen::VectorXd operator()(const Eigen::VectorXd& x) const {
+    Eigen::VectorXd res(2);
+    double f1 = x(0);
+    double g = 1.0;
+    for (int i = 1; i < x.size(); ++i)
+      g += 9.0 / (x.size() - 1) * x(i);
+    double h = 1.0f - pow((f1 / g), 2.0);
+    double f2 = g * h;
+    res(0) = 1.0 - f1;
+    res(1) = 1.0 - f2;
+    return res;
+  }
+};
+
+struct mop2 {
+  static constexpr size_t dim = 2;
+  Eigen::VectorXd operator()(const Eigen::VectorXd& x) const {
+    Eigen::VectorXd res(2);
+    // scale to [-2, 2]
+    Eigen::VectorXd xx = (x * 4.0).array() - 2.0;
+    // f1, f2
+    Eigen::VectorXd v1 = (xx.array() - 1.0 / sqrt(xx.size())).array().square();
+    Eigen::VectorXd v2 = (xx.array() + 1.0 / sqrt(xx.size())).array().square();
+    double f1 = 1.0 - exp(-v1.sum());
+    double f2 = 1.0 - exp(-v2.sum());
+    // we _maximize in [0:1]
+    res(0) = -f1 + 1;
+    res(1) = -f2 + 1;
+    return res;
+  }
+};
+
+struct result_t {
+  std::string algo, problem;
+  int replicate;
+  unsigned seed;
+  size_t nb_evals, pareto_size;
+  double hv;
+  // seconds
+  double model_fit, inner_opt, pareto_update, total;
+};
+
+// hypervolume dominated by the Pareto front of the observations, with
+// (0, 0) as the reference point (the objectives of the problems are
+// maximized and the optimal fronts are in [0, 1]^2)
+template<typename Opt>
+double hypervolume(const Opt& opt) {
+  std::vector<std::pair<double, double> > p;
+  for (int i = 0; i < opt.pareto_data_objs().rows(); ++i)
+    p.push_back(std::make_pair(opt.pareto_data_objs()(i, 0), opt.pareto_data_objs()(i, 1)));
+  // decreasing first objective: the second one increases along the front
+  std::sort(p.rbegin(), p.rend());
+  double hv = 0, y = 0;
+  for (size_t i = 0; i < p.size(); ++i)
+    if (p[i].first > 0 && p[i].second > y) {
+      hv += p[i].first * (p[i].second - y);
+      y = p[i].second;
+    }
+  return hv;
+}
+
+template<typename Opt, typename F>
+result_t run(const std::string& algo, const std::string& problem,
+             int replicate, unsigned seed) {
+  std::mt19937 gen(seed);
+  misc::ScopedGenerator scoped_gen(gen);
+  Opt opt;
+  result_t r;
+  r.total = 0;
+  {
+    misc::ScopedTimer timer(r.total);
+    opt.optimize(F());
+    // the last sample is not in the front of EHVI and NSBO
+    opt.update_pareto_data();
+  }
+  r.algo = algo;
+  r.problem = problem;
+  r.replicate = replicate;
+  r.seed = seed;
+  r.nb_evals = opt.samples().size();
+  r.pareto_size = opt.pareto_data().size();
+  r.hv = hypervolume(opt);
+  r.model_fit = opt.timings().model_fit;
+  r.inner_opt = opt.timings().inner_opt;
+  r.pareto_update = opt.timings().pareto_update;
+  return r;
+}
+
+// the jobs of an algorithm on all the problems
+template<template<typename, typename ...> class Opt>
+void add_jobs(std::vector<std::function<result_t()> >& jobs,
+              const std::string& algo, int nb_replicates, unsigned seed) {
+  typedef stat_fun<boost::fusion::vector<> > no_stat_t;
+  for (int k = 0; k < nb_replicates; ++k) {
+    jobs.push_back([ = ]() {
+      return run<Opt<Params, no_stat_t>, zdt2<2> >(algo, "zdt2_dim2", k, seed + k);
+    });
+    jobs.push_back([ = ]() {
+      return run<Opt<Params, no_stat_t>, zdt2<6> >(algo, "zdt2_dim6", k, seed + k);
+    });
+    jobs.push_back([ = ]() {
+      return run<Opt<Params, no_stat_t>, mop2>(algo, "mop2", k, seed + k);
+    });
+  }
+}
+
+int main(int argc, char** argv) {
+  par::init();
+  int nb_replicates = argc > 1 ? atoi(argv[1]) : 10;
+  std::string fname = argc > 2 ? argv[2] : "replicates.dat";
+  unsigned seed = argc > 3 ? atoi(argv[3]) : 0;
+
+  std::vector<std::function<result_t()> > jobs;
+  add_jobs<Parego>(jobs, "parego", nb_replicates, seed);
+  add_jobs<Nsbo>(jobs, "nsbo", nb_replicates, seed);
+  add_jobs<Ehvi>(jobs, "ehvi", nb_replicates, seed);
+
+  std::vector<result_t> results(jobs.size());
+  par::loop(0, jobs.size(), [&](size_t i) {
+    par::serial([&]() {
+      results[i] = jobs[i]();
+    });
+  });
+
+  std::ofstream ofs(fname.c_str());
+  ofs << "# algo problem replicate seed evals pareto_size hypervolume"
+      << " model_fit inner_opt pareto_update total" << std::endl;
+  for (auto r : results)
+    ofs << r.algo << " " << r.problem << " " << r.replicate << " " << r.seed << " "
+        << r.nb_evals << " " << r.pareto_size << " " << r.hv << " "
+        << r.model_fit << " " << r.inner_opt << " " << r.pareto_update << " "
+        << r.total << std::endl;
+  std::cout << fname << " written (" << results.size() << " replicates)" << std::endl;
+  return 0;
+}
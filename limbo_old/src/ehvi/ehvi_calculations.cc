@@ -2,6 +2,7 @@
 #include "helper.h"
 #include "ehvi_hvol.h"
 #include <deque>
+#include <vector>
 #include <algorithm> //sorting
 #include <math.h> //INFINITY macro
 using namespace std;
@@ -10,14 +11,17 @@ using namespace std;
 //to NOT use O(1) S-minus updates:
 //#define NAIVE_DOMPOINTS
 
-//Returns the expected 2d hypervolume improvement of population P with reference
-//point r, mean vector mu and standard deviation vector s.
-double ehvi2d(deque<individual*> P, double r[], double mu[], double s[]){
-  sort(P.begin(), P.end(), xcomparator);
+static bool pointxcomparator(const double * A, const double * B){
+  return A[0] < B[0];
+}
+
+//ehvi2d with the coordinates of the points sorted in ascending order of x.
+static double ehvi2d_sorted(const vector<const double*> & P, const double r[], const double mu[], const double s[]){
   double answer = 0; //The eventual answer
   int k = P.size(); //Holds amount of points.
   #ifdef NAIVE_DOMPOINTS
   deque<individual*> dompoints; //For the old-fashioned way.
+  deque<individual> domstore;
   #endif
   double Sminus; //Correction term for the integral.
   int Sstart = k-1, Shorizontal = 0;
@@ -34,31 +38,36 @@ double ehvi2d(deque<individual*> P, double r[], double mu[], double s[]){
         cu1 = INFINITY;
       }
       else {
-        fmax[1] = P[j]->f[1];
-        cu1 = P[j]->f[0];
+        fmax[1] = P[j][1];
+        cu1 = P[j][0];
       }
       if (i == k){
         fmax[0] = r[0];
         cu2 = INFINITY;
       }
       else {
-        fmax[0] = P[k-i-1]->f[0];
-        cu2 = P[k-i-1]->f[1];
+        fmax[0] = P[k-i-1][0];
+        cu2 = P[k-i-1][1];
       }
-      cl1 = (j == 0 ? r[0] : P[j-1]->f[0]);
-      cl2 = (i == 0 ? r[1] : P[k-i]->f[1]);
+      cl1 = (j == 0 ? r[0] : P[j-1][0]);
+      cl2 = (i == 0 ? r[1] : P[k-i][1]);
       //Cell boundaries have been decided. Determine Sminus.
       #ifdef NAIVE_DOMPOINTS
       dompoints.clear();
+      domstore.clear();
       for (int m = 0; m < k; m++){
-        if (cl1 >= P[m]->f[0] && cl2 >= P[m]->f[1]){
-          dompoints.push_back(P[m]);
+        if (cl1 >= P[m][0] && cl2 >= P[m][1]){
+          individual ind;
+          ind.f[0] = P[m][0];
+          ind.f[1] = P[m][1];
+          domstore.push_back(ind);
+          dompoints.push_back(&domstore.back());
         }
       }
       Sminus = calculateS(dompoints, fmax);
       #else
       if (Shorizontal > Sstart){
-        Sminus += (P[Shorizontal]->f[0] - fmax[0]) * (P[Shorizontal]->f[1] - fmax[1]);
+        Sminus += (P[Shorizontal][0] - fmax[0]) * (P[Shorizontal][1] - fmax[1]);
       }
       Shorizontal++;
       #endif
@@ -76,6 +85,25 @@ double ehvi2d(deque<individual*> P, double r[], double mu[], double s[]){
   return answer;
 }
 
+//Returns the expected 2d hypervolume improvement of population P with reference
+//point r, mean vector mu and standard deviation vector s.
+double ehvi2d(deque<individual*> P, double r[], double mu[], double s[]){
+  vector<const double*> points(P.size());
+  for (unsigned int i=0;i<P.size();i++)
+    points[i] = P[i]->f;
+  sort(points.begin(), points.end(), pointxcomparator);
+  return ehvi2d_sorted(points, r, mu, s);
+}
+
+//Same as above with the points read in place from a span.
+double ehvi2d(const frontspan & P, const double r[], const double mu[], const double s[]){
+  vector<const double*> points(P.n);
+  for (int i=0;i<P.n;i++)
+    points[i] = P[i];
+  sort(points.begin(), points.end(), pointxcomparator);
+  return ehvi2d_sorted(points, r, mu, s);
+}
+
 //Subtracts expected dominated dominated hypervolume from expected dominated hypervolume.
 double ehvi3d_2term(deque<individual*> P, double r[], double mu[], double s[]){
   double answer = 0; //The eventual answer.
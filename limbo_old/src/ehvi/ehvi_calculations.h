@@ -9,6 +9,9 @@ using namespace std;
 
 double ehvi2d(deque<individual*> P, double r[], double mu[], double s[]);
 
+//Zero-copy version: the points are read in place (see frontspan).
+double ehvi2d(const frontspan & P, const double r[], const double mu[], const double s[]);
+
 double ehvi3d_2term(deque<individual*> P, double r[], double mu[], double s[]);
 
 double ehvi3d_5term(deque<individual*> P, double r[], double mu[], double s[]);
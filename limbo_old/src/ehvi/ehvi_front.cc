@@ -0,0 +1,219 @@
+//Preprocessed population for the slice-update scheme (see ehvi_front.h).
+#include <algorithm>
+#include <cmath> //INFINITY macro
+#include "ehvi_front.h"
+using namespace std;
+
+//Point of the front with its position in the sorted orders (see specialind).
+struct frontind{
+  const double * f;
+  int xorder, yorder, zorder;
+};
+
+static bool frontxcomparator(const double * A, const double * B){
+  return A[0] < B[0];
+}
+
+static bool frontycomparator(frontind * A, frontind * B){
+  return A->f[1] < B->f[1];
+}
+
+static bool frontzcomparator(frontind * A, frontind * B){
+  return A->f[2] < B->f[2];
+}
+
+ehvi3d_front::ehvi3d_front(const frontspan & P, const double ref[]) : n(P.n){
+  for (int d=0;d<DIMENSIONS;d++)
+    r[d] = ref[d];
+  vector<const double*> points(n);
+  for (int i=0;i<n;i++)
+    points[i] = P[i];
+  init(points);
+}
+
+ehvi3d_front::ehvi3d_front(const deque<individual*> & P, const double ref[]) : n(P.size()){
+  for (int d=0;d<DIMENSIONS;d++)
+    r[d] = ref[d];
+  vector<const double*> points(n);
+  for (int i=0;i<n;i++)
+    points[i] = P[i]->f;
+  init(points);
+}
+
+void ehvi3d_front::init(const vector<const double*> & points){
+  //Sorted arrays with the position of each point in the other orders, as in
+  //ehvi3d_sliceupdate.
+  vector<const double*> P(points);
+  vector<frontind> inds(n);
+  vector<frontind*> Px(n), Py(n), Pz(n);
+  sort(P.begin(), P.end(), frontxcomparator);
+  for (int i=0;i<n;i++){
+    inds[i].f = P[i];
+    inds[i].xorder = i;
+    Px[i] = Py[i] = Pz[i] = &inds[i];
+  }
+  sort(Py.begin(), Py.end(), frontycomparator);
+  for (int i=0;i<n;i++)
+    Py[i]->yorder = i;
+  sort(Pz.begin(), Pz.end(), frontzcomparator);
+  for (int i=0;i<n;i++)
+    Pz[i]->zorder = i;
+  for (int d=0;d<DIMENSIONS;d++){
+    b[d].resize(n+2);
+    b[d][0] = r[d];
+    b[d][n+1] = INFINITY;
+  }
+  for (int i=0;i<n;i++){
+    b[0][i+1] = Px[i]->f[0];
+    b[1][i+1] = Py[i]->f[1];
+    b[2][i+1] = Pz[i]->f[2];
+  }
+  lookup.assign((n+1)*(n+1)*(n+1), -1);
+  vector<thingy> Pstruct(n*n);
+  for (int k=0;k<n*n;k++){
+    Pstruct[k].slice = 0;
+    Pstruct[k].chunk = 0;
+    Pstruct[k].highestdominator = -1;
+    Pstruct[k].xlim = 0;
+    Pstruct[k].ylim = 0;
+  }
+  //Dominance in the 2-dimensional slices (O(n^3)).
+  for (int i=0;i<n;i++){
+    for (int j=Pz[i]->yorder;j>=0;j--)
+      for (int k=Pz[i]->xorder;k>=0;k--)
+        Pstruct[k+j*n].highestdominator = i;
+    for (int j=Px[i]->zorder;j>=0;j--)
+      for (int k=Px[i]->yorder;k>=0;k--)
+        Pstruct[k+j*n].xlim = Px[i]->f[0] - r[0];
+    for (int j=Py[i]->zorder;j>=0;j--)
+      for (int k=Py[i]->xorder;k>=0;k--)
+        Pstruct[k+j*n].ylim = Py[i]->f[1] - r[1];
+  }
+  for (int z=0;z<=n;z++){
+    //Update of the chunks with the slices of the previous z.
+    if (z>0)
+      for (int i=0;i<n*n;i++)
+        Pstruct[i].chunk += Pstruct[i].slice * (b[2][z] - b[2][z-1]);
+    for (int y=0;y<n;y++)
+      for (int x=0;x<n;x++){
+        if (Pstruct[x+y*n].highestdominator < z){
+          if (x > 0 && y > 0)
+            Pstruct[x+y*n].slice = (Pstruct[x+(y-1)*n].slice - Pstruct[(x-1)+(y-1)*n].slice) + Pstruct[(x-1)+y*n].slice;
+          else if (y > 0)
+            Pstruct[x+y*n].slice = Pstruct[x+(y-1)*n].slice;
+          else if (x > 0)
+            Pstruct[x+y*n].slice = Pstruct[(x-1)+y*n].slice;
+          else
+            Pstruct[x+y*n].slice = 0;
+        }
+        else
+          Pstruct[x+y*n].slice = (Px[x]->f[0] - r[0]) * (Py[y]->f[1] - r[1]);
+      }
+    //The cells of this z that are not dominated nor of size 0.
+    for (int y=0;y<=n;y++)
+      for (int x=0;x<=n;x++){
+        double cellength[DIMENSIONS];
+        cellength[0] = b[0][x+1] - b[0][x];
+        cellength[1] = b[1][y+1] - b[1][y];
+        cellength[2] = b[2][z+1] - b[2][z];
+        if (cellength[0] == 0 || cellength[1] == 0 || cellength[2] == 0 || (x < n && y < n && Pstruct[x+y*n].highestdominator >= z))
+          continue;
+        ehvi3d_cell c;
+        c.x = x;
+        c.y = y;
+        c.z = z;
+        if (x > 0 && y > 0){
+          c.Sminus = Pstruct[(x-1)+(y-1)*n].chunk;
+          c.slice[0] = (x == n ? 0 : (Pstruct[x+(y-1)*n].chunk - c.Sminus) / cellength[0]);
+          c.slice[1] = (y == n ? 0 : (Pstruct[(x-1)+y*n].chunk - c.Sminus) / cellength[1]);
+          c.slice[2] = Pstruct[(x-1)+(y-1)*n].slice;
+        }
+        else {
+          c.Sminus = 0;
+          c.slice[0] = ((y == 0 || x == n) ? 0 : Pstruct[x+(y-1)*n].chunk / cellength[0]);
+          c.slice[1] = ((x == 0 || y == n) ? 0 : Pstruct[(x-1)+y*n].chunk / cellength[1]);
+          c.slice[2] = 0;
+        }
+        c.v[0] = (y == n || z == n) ? 0 : Pstruct[y+z*n].xlim;
+        c.v[1] = (x == n || z == n) ? 0 : Pstruct[x+z*n].ylim;
+        if (x == n || y == n || Pstruct[x+y*n].highestdominator == -1)
+          c.v[2] = 0;
+        else
+          c.v[2] = Pz[Pstruct[x+y*n].highestdominator]->f[2] - r[2];
+        lookup[x+(n+1)*(y+(n+1)*z)] = grid.size();
+        grid.push_back(c);
+      }
+  }
+}
+
+void ehvi3d_front::terms(const double mu[], const double s[], double * psi, double * cdf, double * ex) const{
+  for (int d=0;d<DIMENSIONS;d++){
+    double psil = exipsi(r[d],b[d][0],mu[d],s[d]);
+    double cdfl = gausscdf((b[d][0]-mu[d])/s[d]);
+    for (int i=0;i<=n;i++){
+      double psiu = exipsi(r[d],b[d][i+1],mu[d],s[d]);
+      double cdfu = gausscdf((b[d][i+1]-mu[d])/s[d]);
+      psi[d*(n+1)+i] = psil - psiu;
+      cdf[d*(n+1)+i] = cdfu - cdfl;
+      ex[d*(n+1)+i] = psi[d*(n+1)+i] - cdf[d*(n+1)+i] * (b[d][i]-r[d]);
+      psil = psiu;
+      cdfl = cdfu;
+    }
+  }
+}
+
+double ehvi3d_front::ehvi(const double mu[], const double s[]) const{
+  vector<mus> pdf(1);
+  vector<mus*> ppdf(1, &pdf[0]);
+  for (int d=0;d<DIMENSIONS;d++){
+    pdf[0].mu[d] = mu[d];
+    pdf[0].s[d] = s[d];
+  }
+  return ehvi(ppdf)[0];
+}
+
+vector<double> ehvi3d_front::ehvi(const vector<mus*> & pdf) const{
+  int m = pdf.size();
+  int stride = DIMENSIONS*(n+1);
+  vector<double> psi(m*stride), cdf(m*stride), ex(m*stride);
+  for (int i=0;i<m;i++)
+    terms(pdf[i]->mu, pdf[i]->s, &psi[i*stride], &cdf[i*stride], &ex[i*stride]);
+  vector<double> answer(m, 0);
+  //Cells in the outer loop: each cell is read once for all the distributions.
+  for (size_t k=0;k<grid.size();k++){
+    const ehvi3d_cell & c = grid[k];
+    int ix = c.x, iy = (n+1) + c.y, iz = 2*(n+1) + c.z;
+    for (int i=0;i<m;i++){
+      const double * p = &psi[i*stride], * g = &cdf[i*stride], * e = &ex[i*stride];
+      double sum = (p[ix]*p[iy]*p[iz]) - (c.Sminus*g[ix]*g[iy]*g[iz]);
+      sum -= (c.slice[0] * g[iy] * g[iz] * e[ix]);
+      sum -= (c.slice[1] * g[ix] * g[iz] * e[iy]);
+      sum -= (c.slice[2] * g[ix] * g[iy] * e[iz]);
+      sum -= c.v[0] * e[iy] * e[iz] * g[ix];
+      sum -= c.v[1] * e[ix] * e[iz] * g[iy];
+      sum -= c.v[2] * e[ix] * e[iy] * g[iz];
+      if (sum > 0)
+        answer[i] += sum;
+    }
+  }
+  return answer;
+}
+
+double ehvi3d_front::hvi(const double p[]) const{
+  int i[DIMENSIONS];
+  double d[DIMENSIONS];
+  for (int k=0;k<DIMENSIONS;k++){
+    if (p[k] <= r[k])
+      return 0;
+    i[k] = upper_bound(b[k].begin(), b[k].end(), p[k]) - b[k].begin() - 1;
+    d[k] = p[k] - b[k][i[k]];
+  }
+  int k = lookup[i[0]+(n+1)*(i[1]+(n+1)*i[2])];
+  if (k < 0)
+    return 0;
+  const ehvi3d_cell & c = grid[k];
+  double answer = (p[0]-r[0]) * (p[1]-r[1]) * (p[2]-r[2]) - c.Sminus;
+  answer -= c.slice[0]*d[0] + c.slice[1]*d[1] + c.slice[2]*d[2];
+  answer -= c.v[0]*d[1]*d[2] + c.v[1]*d[0]*d[2] + c.v[2]*d[0]*d[1];
+  return answer > 0 ? answer : 0;
+}
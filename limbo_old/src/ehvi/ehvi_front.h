@@ -0,0 +1,53 @@
+//Include this to compute the EHVI of many Gaussian distributions against
+//the same population. The population is preprocessed once with the
+//slice-update scheme (O(n^3)): the grid cells that are not dominated are
+//stored with their correction terms, and only the Gaussian terms are
+//computed for each distribution (O(n) calls to the Gaussian functions,
+//then O(n^3) products).
+#ifndef EHVI_FRONT_H
+#define EHVI_FRONT_H
+#include <deque>
+#include <vector>
+#include "helper.h"
+#include "ehvi_multi.h"
+using namespace std;
+
+//Non-dominated cell of the grid, with the correction terms of the slice-update
+//scheme. x, y, z index the lower boundaries of the cell (see ehvi3d_front::bounds).
+struct ehvi3d_cell{
+  int x, y, z;
+  double Sminus;
+  double slice[DIMENSIONS];
+  double v[DIMENSIONS];
+};
+
+class ehvi3d_front{
+public:
+  //P is assumed to be mutually nondominated (as in ehvi3d_sliceupdate). The
+  //points are only read during the construction.
+  ehvi3d_front(const frontspan & P, const double r[]);
+  ehvi3d_front(const deque<individual*> & P, const double r[]);
+  //Amount of points.
+  int size() const { return n; }
+  //Boundaries of the grid in dimension d: r, then the sorted coordinates, then INFINITY.
+  const vector<double> & bounds(int d) const { return b[d]; }
+  const vector<ehvi3d_cell> & cells() const { return grid; }
+  double ehvi(const double mu[], const double s[]) const;
+  //Hypervolume improvement of the point p, in O(log n) (the terms of its cell
+  //are the ones of the EHVI integral with all the probability mass in p).
+  double hvi(const double p[]) const;
+  //Batched version: one answer per distribution.
+  vector<double> ehvi(const vector<mus*> & pdf) const;
+private:
+  int n;
+  double r[DIMENSIONS];
+  vector<double> b[DIMENSIONS];
+  vector<ehvi3d_cell> grid;
+  //Index in grid of the cell x + (n+1) * (y + (n+1) * z), -1 if it is dominated.
+  vector<int> lookup;
+  void init(const vector<const double*> & P);
+  //psi, gausscdf and expected distance to the lower corner of each of the n+1
+  //intervals in each dimension, for one distribution.
+  void terms(const double mu[], const double s[], double * psi, double * cdf, double * ex) const;
+};
+#endif
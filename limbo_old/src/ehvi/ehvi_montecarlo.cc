@@ -1,69 +1,72 @@
-#include "ehvi_hvol.h"
 #include "ehvi_montecarlo.h"
-#include <random>
 #include <deque>
-#include <algorithm>
 #include <math.h>
 #include "ehvi_consts.h"
-#include <fstream>
 using namespace std;
 
 const double TWOPI = 6.28318530718;
+//Samples generated at once (normals are produced in blocks so that the loops
+//can be vectorized), and before the stopping rule is applied.
+const int MONTECARLO_BLOCK = 256;
+const long long MONTECARLO_MIN = 4096LL;
 
-//Box-Muller transform using a Mersenne Twister.
-class RNG{
-  public:
-    mt19937 twister;
-    RNG(){
-      saved = false;
-      twister.seed(SEED);
-    }
+//SplitMix64 finalizer.
+static unsigned long long mix(unsigned long long z){
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
 
-    double getnumber(double mu, double s){
-      if (saved){
-        saved = false;
-        return (s*savednumber) + mu;
-      }
-      double U1 = (double)twister()/twister.max();
-      double U2 = (double)twister()/twister.max();
-      double R = sqrt(-2 * log(U1));
-      double theta = TWOPI * U2;
-      savednumber = R * cos(theta);
-      saved = true;
-      return (s * R * sin(theta)) + mu;
-    }
+counter_rng::counter_rng(unsigned long long seed, unsigned long long stream){
+  key = mix(mix(seed) + stream * 0x9e3779b97f4a7c15ULL);
+}
 
-  private:
-    bool saved;
-    double savednumber;
-} rng;
+double counter_rng::uniform(unsigned long long counter) const{
+  return ((mix(key + counter * 0x9e3779b97f4a7c15ULL) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
 
-double ehvi3d_montecarlo(deque<individual*> P, double r[], double mu[], double s[]){
+double ehvi3d_montecarlo(const ehvi3d_front & front, const double mu[], const double s[],
+                         unsigned long long stream, double tolerance){
 //Monte Carlo simulation. Gives an approximation of the EHVI by repeatedly
 //generating pseudorandom normally-distributed points and calculating their
-//hypervolume improvement.
-  double answer = 0;
-  individual candidate;
-  sort(P.begin(), P.end(), zcomparator);
-  for (int i=1;i<=MONTECARLOS;i++){
-    //Generate new candidate individual. If it fails to dominate r, we discard it.
-    candidate.f[0] = rng.getnumber(mu[0],s[0]);
-    if (candidate.f[0] <= r[0])
-      continue;
-    candidate.f[1] = rng.getnumber(mu[1],s[1]);
-    if (candidate.f[1] <= r[1])
-      continue;
-    candidate.f[2] = rng.getnumber(mu[2],s[2]);
-    if (candidate.f[2] <= r[2])
-      continue;
-    //Calculate its hypervolume improvement by subtracting already-covered hypervolume
-    //from the box covered by the candidate.
-    double hvol = (candidate.f[0] - r[0]) * (candidate.f[1] - r[1]) * (candidate.f[2] - r[2]);
-    double Sminus = hvol3d(P, r, candidate.f);
-    hvol -= Sminus;
-    if (hvol > 0)
-      answer += hvol;
+//hypervolume improvement (see ehvi3d_front::hvi).
+  counter_rng rng(SEED, stream);
+  //Box-Muller: each pair of uniform numbers gives 2 normal numbers.
+  const int nb_normals = MONTECARLO_BLOCK * DIMENSIONS;
+  double u1[nb_normals / 2], u2[nb_normals / 2], normals[nb_normals];
+  double sum = 0, sumsq = 0;
+  long long n = 0;
+  unsigned long long counter = 0;
+  while (n < MONTECARLOS){
+    for (int i=0;i<nb_normals/2;i++){
+      u1[i] = rng.uniform(counter++);
+      u2[i] = rng.uniform(counter++);
+    }
+    for (int i=0;i<nb_normals/2;i++){
+      double R = sqrt(-2 * log(u1[i]));
+      normals[2*i] = R * cos(TWOPI * u2[i]);
+      normals[2*i+1] = R * sin(TWOPI * u2[i]);
+    }
+    for (int i=0;i<MONTECARLO_BLOCK;i++){
+      double p[DIMENSIONS];
+      for (int d=0;d<DIMENSIONS;d++)
+        p[d] = s[d] * normals[i*DIMENSIONS+d] + mu[d];
+      double hvi = front.hvi(p);
+      sum += hvi;
+      sumsq += hvi * hvi;
+    }
+    n += MONTECARLO_BLOCK;
+    if (n >= MONTECARLO_MIN){
+      double mean = sum / n;
+      double var = sumsq / n - mean * mean;
+      if (sqrt(var > 0 ? var / n : 0) <= tolerance * mean)
+        break;
+    }
   }
-  return answer / MONTECARLOS;
+  return sum / n;
 }
 
+double ehvi3d_montecarlo(deque<individual*> P, double r[], double mu[], double s[]){
+  ehvi3d_front front(P, r);
+  return ehvi3d_montecarlo(front, mu, s);
+}
@@ -1,5 +1,26 @@
 //include this to use the Monte Carlo EHVI calculation scheme.
+#ifndef EHVI_MONTECARLO_H
+#define EHVI_MONTECARLO_H
 #include <deque>
 #include "helper.h"
+#include "ehvi_front.h"
+
+//Counter-based random number generator: the n-th number of a stream is a hash
+//of (seed, stream, n), so there is no state to share between threads and any
+//number of independent streams can be used at the same time.
+struct counter_rng{
+  unsigned long long key;
+  counter_rng(unsigned long long seed, unsigned long long stream);
+  //Uniform in (0, 1].
+  double uniform(unsigned long long counter) const;
+};
+
+//Thread-safe: the random numbers only depend on the stream (the same stream for
+//several candidates gives common random numbers, so the comparison of their
+//estimates is less noisy). Stops when the standard error of the estimate is below
+//tolerance times the estimate, or after MONTECARLOS samples.
+double ehvi3d_montecarlo(const ehvi3d_front & front, const double mu[], const double s[],
+                         unsigned long long stream = 0, double tolerance = 0.001);
 
 double ehvi3d_montecarlo(deque<individual*> P, double r[], double mu[], double s[]);
+#endif
@@ -1,6 +1,8 @@
 //Include this if you want to calculate the EHVI of multiple individuals at the same
 //time. This is more efficient than repeatedly calling an EHVI function on the same
 //population.
+#ifndef EHVI_MULTI_H
+#define EHVI_MULTI_H
 #include "helper.h"
 #include "ehvi_consts.h"
 #include <vector>
@@ -13,3 +15,4 @@ struct mus{ //Holds mean & variance for a Gaussian distribution
 
 vector<double> ehvi3d_5term(deque<individual*> P, double r[], vector<mus *> & pdf);
 vector<double> ehvi3d_sliceupdate(deque<individual*> P, double r[], vector<mus *> & pdf);
+#endif
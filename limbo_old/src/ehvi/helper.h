@@ -9,6 +9,16 @@ struct individual{
   double f[DIMENSIONS];
 };
 
+//Read-only view of n points stored contiguously, without copy: the coordinates
+//of point i are f[i*stride], f[i*stride+1], ... (e.g. a row-major matrix with one
+//row per point, or an array of individuals with stride DIMENSIONS).
+struct frontspan{
+  const double * f;
+  int n;
+  int stride;
+  const double * operator[](int i) const { return f + i*stride; }
+};
+
 //This struct holds the heightmaps and an array of dominated hypervolumes
 //used in the cell calculations for the current z value.
 //To update chunk, all values of slice are multiplied by height
@@ -94,6 +94,16 @@ namespace limbo {
     // point, obj, sigma
     typedef std::tuple<Eigen::VectorXd, Eigen::VectorXd, Eigen::VectorXd> pareto_point_t;
     typedef std::vector<pareto_point_t> pareto_t;
+    // one row per point, stored contiguously
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> pareto_objs_t;
+    // wall-clock time spent in each phase since the creation of the
+    // optimizer (seconds)
+    struct timings_t {
+      timings_t() : model_fit(0), inner_opt(0), pareto_update(0) {}
+      double model_fit;
+      double inner_opt;
+      double pareto_update;
+    };
 
     size_t nb_objs() const {
       return this->_observations[0].size();
@@ -107,16 +117,29 @@ namespace limbo {
       return _pareto_data;
     }
 
+    // objectives of pareto_data(), in the same order
+    const pareto_objs_t& pareto_data_objs() const {
+      return _pareto_data_objs;
+    }
+
+    const timings_t& timings() const {
+      return _timings;
+    }
+
     const std::vector<model_t>& models() const {
       return _models;
     }
 
     // will be called at the end of the algo
     void update_pareto_data() {
+      misc::ScopedTimer timer(_timings.pareto_update);
       std::vector<Eigen::VectorXd> v(this->_samples.size());
       size_t dim = this->_observations[0].size();
       std::fill(v.begin(), v.end(), Eigen::VectorXd::Zero(dim));
       _pareto_data = pareto::pareto_set<1>(_pack_data(this->_samples, this->_observations, v));
+      _pareto_data_objs.resize(_pareto_data.size(), dim);
+      for (size_t i = 0; i < _pareto_data.size(); ++i)
+        _pareto_data_objs.row(i) = std::get<1>(_pareto_data[i]);
     }
 
     // will be called at the end of the algo
@@ -124,9 +147,13 @@ namespace limbo {
     void update_pareto_model() {
       std::cout << "updating models...";
       std::cout.flush();
-      this->_update_models();
+      {
+        misc::ScopedTimer timer(_timings.model_fit);
+        this->_update_models();
+      }
       std::cout << "ok" << std::endl;
 #ifdef USE_SFERES
+      misc::ScopedTimer timer(_timings.pareto_update);
 
       typedef sferes::gen::EvoFloat<D, multi::SferesParams> gen_t;
       typedef sferes::phen::Parameters<gen_t, multi::SferesFit<model_t>, multi::SferesParams> phen_t;
@@ -162,6 +189,8 @@ namespace limbo {
     std::vector<model_t> _models;
     pareto_t _pareto_model;
     pareto_t _pareto_data;
+    pareto_objs_t _pareto_data_objs;
+    timings_t _timings;
 
     pareto_t _pack_data(const std::vector<Eigen::VectorXd>& points,
                         const std::vector<Eigen::VectorXd>& objs,
@@ -2,37 +2,104 @@
 #define EHVI_HPP_
 
 #include <algorithm>
+#include <memory>
 #include "bo_multi.hpp"
 #include "ehvi/ehvi_calculations.h"
 #include "ehvi/ehvi_sliceupdate.h"
+#include "ehvi/ehvi_front.h"
+#include "ehvi/ehvi_montecarlo.h"
 
 namespace limbo {
+  namespace defaults {
+    struct ehvi {
+      BO_PARAM(double, x_ref, -11);
+      BO_PARAM(double, y_ref, -11);
+      // only used with 3 objectives
+      BO_PARAM(double, z_ref, -11);
+      // 3 objectives: Monte Carlo estimate instead of the exact EHVI
+      // (stops when the standard error is below mc_tolerance times the
+      // estimate)
+      BO_PARAM(bool, montecarlo, false);
+      BO_PARAM(double, mc_tolerance, 0.001);
+    };
+  }
+
   namespace acquisition_functions {
-    // only work in 2D for now
+    // 2 or 3 objectives; the points of the population are read in
+    // place (e.g. BoMulti::pareto_data_objs()), so they must outlive the
+    // acquisition function. With 3 objectives, the population is
+    // preprocessed once (slice-update scheme, see ehvi/ehvi_front.h) and
+    // shared by all the evaluations
     template<typename Params, typename Model>
     class Ehvi {
      public:
       Ehvi(const std::vector<Model>& models,
-           const std::deque<individual*>& pop,
+           const frontspan& pop,
            const Eigen::VectorXd& ref_point)
         : _models(models), _pop(pop), _ref_point(ref_point) {
-        assert(_models.size() == 2);
+        assert(_models.size() == 2 || _models.size() == 3);
+        assert((size_t) _ref_point.size() == _models.size());
+        assert(_pop.stride >= (int) _models.size());
+        if (_models.size() == 3) {
+          double r[3] = { _ref_point(0), _ref_point(1), _ref_point(2) };
+          _front = std::make_shared<ehvi3d_front>(_pop, r);
+        }
       }
       size_t dim() const {
         return _models[0].dim();
       }
       double operator()(const Eigen::VectorXd& v) const {
-        assert(_models.size() == 2);
-        double r[3] = { _ref_point(0), _ref_point(1), _ref_point(2) };
-        double mu[3] = { _models[0].mu(v), _models[1].mu(v), 0 };
-        double s[3] = { _models[0].sigma(v), _models[1].sigma(v), 0 };
-        double ehvi = ehvi2d(_pop, r, mu, s);
-        return ehvi;
+        mus pdf = _pdf(v);
+        // the same random stream for all the points (common random
+        // numbers), which is safe in par::max since the generator is
+        // stateless
+        if (_front && Params::ehvi::montecarlo())
+          return ehvi3d_montecarlo(*_front, pdf.mu, pdf.s, 0,
+                                   Params::ehvi::mc_tolerance());
+        if (_front)
+          return _front->ehvi(pdf.mu, pdf.s);
+        double r[3] = { _ref_point(0), _ref_point(1), 0 };
+        return ehvi2d(_pop, r, pdf.mu, pdf.s);
+      }
+      // EHVI of a whole set of points (e.g. a CMA-ES population or the
+      // candidates of NSGA-II): with 3 objectives, each block of points
+      // is evaluated in one pass over the preprocessed front
+      std::vector<double> batch(const std::vector<Eigen::VectorXd>& vs) const {
+        std::vector<double> res(vs.size());
+        if (!_front || Params::ehvi::montecarlo()) {
+          par::loop(0, vs.size(), [&](size_t i) {
+            res[i] = (*this)(vs[i]);
+          });
+          return res;
+        }
+        static const size_t block = 16;
+        par::loop(0, (vs.size() + block - 1) / block, [&](size_t b) {
+          size_t end = std::min(vs.size(), (b + 1) * block);
+          std::vector<mus> pdf;
+          for (size_t i = b * block; i < end; ++i)
+            pdf.push_back(_pdf(vs[i]));
+          std::vector<mus*> ppdf;
+          for (size_t i = 0; i < pdf.size(); ++i)
+            ppdf.push_back(&pdf[i]);
+          std::vector<double> e = _front->ehvi(ppdf);
+          std::copy(e.begin(), e.end(), res.begin() + b * block);
+        });
+        return res;
       }
      protected:
       const std::vector<Model>& _models;
-      const std::deque<individual*>& _pop;
+      frontspan _pop;
       Eigen::VectorXd _ref_point;
+      std::shared_ptr<ehvi3d_front> _front;
+
+      mus _pdf(const Eigen::VectorXd& v) const {
+        mus pdf;
+        pdf.mu[2] = 0;
+        pdf.s[2] = 0;
+        for (size_t i = 0; i < _models.size(); ++i)
+          std::tie(pdf.mu[i], pdf.s[i]) = _models[i].query(v);
+        return pdf;
+      }
     };
   }
 
@@ -63,22 +130,21 @@ namespace limbo {
         this->template update_pareto_model<EvalFunction::dim>();
         this->update_pareto_data();
 
-        // copy in the ehvi structure to compute expected improvement
-        std::deque<individual*> pop;
-        for (auto x : this->pareto_data()) {
-          individual* ind = new individual;
-          ind->f[0] = std::get<1>(x)(0);
-          ind->f[1] = std::get<1>(x)(1);
-          ind->f[2] = 0;
-          pop.push_back(ind);
-        }
+        // the ehvi functions read the objectives in place
+        const auto& objs = this->pareto_data_objs();
+        frontspan pop = { objs.data(), (int) objs.rows(), (int) objs.cols() };
+        Eigen::VectorXd ref_point(this->nb_objs());
+        ref_point(0) = Params::ehvi::x_ref();
+        ref_point(1) = Params::ehvi::y_ref();
+        if (this->nb_objs() == 3)
+          ref_point(2) = Params::ehvi::z_ref();
 
         // optimize ehvi
         std::cout << "optimizing ehvi (" << this-> pareto_data().size() << ")" << std::endl;
+        misc::ScopedTimer inner_timer(this->_timings.inner_opt);
 
         auto acqui = acquisition_functions::Ehvi<Params, model_t>
-                     (this->_models, pop,
-                      Eigen::Vector3d(Params::ehvi::x_ref(), Params::ehvi::y_ref(), 0));
+                     (this->_models, pop, ref_point);
 
         // maximize with CMA-ES
         typedef std::pair<Eigen::VectorXd, double> pair_t;
@@ -94,13 +160,17 @@ namespace limbo {
         };
         auto m = par::max(init, this->pareto_data().size(), body, comp);
 
-        // maximize with NSGA-II
-        auto body2 = [&](int i) {
-          auto x = std::get<0>(this->pareto_model()[i]);
-          float hv = acqui(x);
-          return std::make_pair(x, hv);
-        };
-        auto m2 = par::max(init, this->pareto_model().size(), body2, comp);
+        // maximize with NSGA-II (all the candidates in one call)
+        std::vector<Eigen::VectorXd> candidates;
+        for (auto x : this->pareto_model())
+          candidates.push_back(std::get<0>(x));
+        std::vector<double> hvs = acqui.batch(candidates);
+        pair_t m2 = init;
+        for (size_t i = 0; i < candidates.size(); ++i)
+          if (comp(std::make_pair(candidates[i], hvs[i]), m2))
+            m2 = std::make_pair(candidates[i], hvs[i]);
+
+        inner_timer.stop();
 
         // take the best
         std::cout << "best (cmaes):" << m.second << std::endl;
@@ -113,18 +183,15 @@ namespace limbo {
         std::cout << "new sample:" << new_sample.transpose() << std::endl;
 
         std::cout << "expected improvement: " << acqui(new_sample) << std::endl;
-        std::cout << "expected value: " << this->_models[0].mu(new_sample)
-                  << " " << this->_models[1].mu(new_sample)
-                  << " " << this->_models[0].sigma(new_sample)
-                  << " " << this->_models[1].sigma(new_sample)
-                  << std::endl;
+        std::cout << "expected value:";
+        for (size_t i = 0; i < this->nb_objs(); ++i)
+          std::cout << " " << this->_models[i].mu(new_sample);
+        for (size_t i = 0; i < this->nb_objs(); ++i)
+          std::cout << " " << this->_models[i].sigma(new_sample);
+        std::cout << std::endl;
         std::cout << "opt done" << std::endl;
 
 
-        // delete pop
-        for (auto x : pop)
-          delete x;
-
         // add sample
         this->add_new_sample(new_sample, feval(new_sample));
         std::cout << this->_iteration
@@ -48,8 +48,7 @@ namespace limbo {
           Eigen::VectorXd new_sample(F::dim);
           for (size_t i = 0; i < F::dim; i++)
             new_sample[i] =
-              int(((double) (Params::init::nb_bins() + 1) * rand())
-                  / (RAND_MAX + 1.0)) / double(Params::init::nb_bins());
+              misc::rand<int>(0, Params::init::nb_bins() + 1) / double(Params::init::nb_bins());
           opt.add_new_sample(new_sample, feval(new_sample));
         }
       }
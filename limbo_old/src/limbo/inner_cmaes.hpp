@@ -14,6 +14,7 @@
 #include "cmaes/cmaes_interface.h"
 #include "cmaes/boundary_transformation.h"
 #include "limbo/parallel.hpp"
+#include "limbo/rand.hpp"
 
 namespace limbo {
 
@@ -54,12 +55,18 @@ namespace limbo {
         for (int i = 0; i < dim; ++i)
           init_point[i] = init(i);
         for (irun = 0; irun < nrestarts + 1; ++irun) {
-          fitvals = cmaes_init(&evo, acqui.dim(), init_point, NULL, 0, lambda, NULL);
+          // seeded from misc::rand (cmaes uses the time for a seed of 0)
+          long seed = misc::rand<long>(1, 1000000000);
+          fitvals = cmaes_init(&evo, acqui.dim(), init_point, NULL, seed, lambda, NULL);
           evo.countevals = countevals;
           evo.sp.stopMaxFunEvals =
             Params::cmaes::max_fun_evals() < 0 ?
             (900.0 * (dim + 3.0) * (dim + 3.0))
             : Params::cmaes::max_fun_evals();
+          // cmaes skips eigendecompositions that would take more than 20%
+          // of the CPU time (clock()): the search would then depend on
+          // the load of the machine, not only on the seed
+          evo.sp.updateCmode.maxtime = 1.0;
 
           int pop_size =  cmaes_Get(&evo, "popsize");
           double** all_x_in_bounds = new double*[pop_size];
@@ -72,13 +79,14 @@ namespace limbo {
             par::loop(0, pop_size, [&](int i) {
               boundary_transformation(&boundaries, pop[i], all_x_in_bounds[i], dim);
               for (int j = 0; j < dim; ++j)
-                pop_eigen[i](j) = x_in_bounds[j];
-              fitvals[i] = -acqui(pop_eigen[i]);
+                pop_eigen[i](j) = all_x_in_bounds[i][j];
             });
+            _eval_pop(acqui, pop_eigen, fitvals, 0);
             cmaes_UpdateDistribution(&evo, fitvals);
           }
           for (int i = 0; i < pop_size; ++i)
             free(all_x_in_bounds[i]);
+          delete[] all_x_in_bounds;
 
           lambda = incpopsize * cmaes_Get(&evo, "lambda");
           countevals = cmaes_Get(&evo, "eval");
@@ -120,6 +128,25 @@ namespace limbo {
 
       }
      private:
+      // the whole population in one call when the acquisition function
+      // provides batch() (e.g. Ehvi), point by point otherwise
+      template <typename AcquisitionFunction>
+      static auto _eval_pop(const AcquisitionFunction& acqui,
+                            const std::vector<Eigen::VectorXd>& pop,
+                            double* fitvals, int)
+      -> decltype(acqui.batch(pop), void()) {
+        std::vector<double> f = acqui.batch(pop);
+        for (size_t i = 0; i < f.size(); ++i)
+          fitvals[i] = -f[i];
+      }
+      template <typename AcquisitionFunction>
+      static void _eval_pop(const AcquisitionFunction& acqui,
+                            const std::vector<Eigen::VectorXd>& pop,
+                            double* fitvals, long) {
+        par::loop(0, pop.size(), [&](int i) {
+          fitvals[i] = -acqui(pop[i]);
+        });
+      }
       double *_ar_funvals;
       double * const * _cmaes_pop;
       int _lambda;
@@ -32,10 +32,14 @@ namespace limbo {
         std::cout << "ok" << std::endl;
         auto pareto = this->pareto_model();
 
-        // Pareto front of the variances
-        auto p_variance = pareto::pareto_set<2>(pareto);
-        auto best = p_variance[rand() % p_variance.size()];
-        Eigen::VectorXd best_v = std::get<0>(best);
+        Eigen::VectorXd best_v;
+        {
+          misc::ScopedTimer timer(this->_timings.inner_opt);
+          // Pareto front of the variances
+          auto p_variance = pareto::pareto_set<2>(pareto);
+          auto best = p_variance[misc::rand<size_t>(0, p_variance.size())];
+          best_v = std::get<0>(best);
+        }
 
         this->add_new_sample(best_v, feval(best_v));
         this->_iteration++;
@@ -9,6 +9,7 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
 #include <tbb/parallel_reduce.h>
+#include <tbb/task_arena.h>
 #endif
 
 namespace par {
@@ -107,6 +108,24 @@ namespace par {
 #endif
   }
 
+  // runs f with the calling thread only: the parallel loops of f (limbo's
+  // and sferes') are run serially, and the thread does not run the tasks
+  // of other loops while f waits, so that all the random numbers of f
+  // come from the generator of this thread (e.g. a replicate with its
+  // own misc::ScopedGenerator); the jobs that call serial can still be
+  // run in parallel
+  template<typename F>
+  inline void serial(const F& f) {
+#ifdef USE_TBB
+    tbb::task_arena arena(1);
+    arena.execute([&]() {
+      f();
+    });
+#else
+    f();
+#endif
+  }
+
   // replicate a function nb times
   template<typename F>
   inline void replicate(size_t nb, const F& f) {
@@ -36,20 +36,30 @@ namespace limbo {
 
       std::vector<double> scalarized = _scalarize_obs();
       model_t model(EvalFunction::dim);
-      model.compute(this->_samples, scalarized, Params::boptimizer::noise());
+      {
+        misc::ScopedTimer timer(this->_timings.model_fit);
+        model.compute(this->_samples, scalarized, Params::boptimizer::noise());
+      }
 
       inner_optimization_t inner_optimization;
 
       while (this->_samples.size() == 0 || this->_pursue(*this)) {
         acquisition_function_t acqui(model, this->_iteration);
 
-        Eigen::VectorXd new_sample = inner_optimization(acqui, acqui.dim());
+        Eigen::VectorXd new_sample;
+        {
+          misc::ScopedTimer timer(this->_timings.inner_opt);
+          new_sample = inner_optimization(acqui, acqui.dim());
+        }
         this->add_new_sample(new_sample, feval(new_sample));
         std::cout << this->_iteration
                   << " | new sample:" << new_sample.transpose()
                   << " => " << feval(new_sample).transpose() << std::endl;
         scalarized = _scalarize_obs();
-        model.compute(this->_samples, scalarized, Params::boptimizer::noise());
+        {
+          misc::ScopedTimer timer(this->_timings.model_fit);
+          model.compute(this->_samples, scalarized, Params::boptimizer::noise());
+        }
         this->_update_stats(*this);
         this->_iteration++;
       }
@@ -62,8 +72,9 @@ namespace limbo {
     std::vector<double> _scalarize_obs() {
       assert(this->_observations.size() != 0);
 
-      Eigen::VectorXd lambda = Eigen::VectorXd::Random(this->_observations[0].size());
-      lambda = (lambda.array() + 1.0) / 2.0;
+      Eigen::VectorXd lambda(this->_observations[0].size());
+      for (int i = 0; i < lambda.size(); ++i)
+        lambda(i) = misc::rand<double>();
       double sum = lambda.sum();
       lambda = lambda / sum;
       // scalarize (Tchebycheff)
@@ -46,17 +46,77 @@
 #include <stdlib.h>
 #include <boost/swap.hpp>
 #include <random>
+#ifdef USE_SFERES
+#include <sferes/misc/rand.hpp>
+#endif
 
-// someday we will have a real thread-safe random number generator...
 namespace limbo {
   namespace misc {
-    // NOT Thread-safe !
+    // generator installed in the calling thread by a ScopedGenerator
+    inline std::mt19937*& installed_twister() {
+      static thread_local std::mt19937* gen = nullptr;
+      return gen;
+    }
+
+    // generator of the calling thread: the installed one, if any, or
+    // its own one (seeded randomly, see seed())
+    inline std::mt19937& twister() {
+      static thread_local std::mt19937 gen(std::random_device {}());
+      std::mt19937* installed = installed_twister();
+      return installed ? *installed : gen;
+    }
+
+    // seed the generator of the calling thread
+    inline void seed(unsigned s) {
+      twister().seed(s);
+    }
+
+#ifdef USE_SFERES
+    inline double sferes_uniform(void* gen) {
+      return std::uniform_real_distribution<double>(0.0, 1.0)(*static_cast<std::mt19937*>(gen));
+    }
+#endif
+
+    // installs gen as the generator of the calling thread (and, with
+    // USE_SFERES, as the source of sferes::misc::rand, e.g. for the
+    // NSGA-II of BoMulti) until the end of the scope, e.g. one generator
+    // per replicate of an experiment. The previous generator is restored:
+    // a job run by this thread while it waits for a parallel loop does
+    // not disturb the stream of the job it interrupted. The parallel
+    // loops of the scope still draw from the generators of their threads
+    // (see par::serial).
+    class ScopedGenerator {
+     public:
+      ScopedGenerator(std::mt19937& gen) : _prev(installed_twister()) {
+        installed_twister() = &gen;
+#ifdef USE_SFERES
+        _source.uniform = &sferes_uniform;
+        _source.state = &gen;
+        _prev_source = sferes::misc::rand_source();
+        sferes::misc::rand_source() = &_source;
+#endif
+      }
+      ~ScopedGenerator() {
+        installed_twister() = _prev;
+#ifdef USE_SFERES
+        sferes::misc::rand_source() = _prev_source;
+#endif
+      }
+      ScopedGenerator(const ScopedGenerator&) = delete;
+      ScopedGenerator& operator=(const ScopedGenerator&) = delete;
+     protected:
+      std::mt19937* _prev;
+#ifdef USE_SFERES
+      sferes::misc::rand_source_t _source;
+      sferes::misc::rand_source_t* _prev_source;
+#endif
+    };
+
     template<typename T>
     inline T rand(T max = 1.0) {
       assert(max > 0);
-      static std::mt19937 twister( std::time(0) ) ;
-      static std::uniform_real_distribution<double> distr(0.0, 1.0) ;
-      return distr(twister);
+      std::uniform_real_distribution<double> distr(0.0, 1.0) ;
+      return distr(twister());
     }
 
 
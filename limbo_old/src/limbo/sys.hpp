@@ -39,6 +39,7 @@
 #define LIMBO_SYS_HPP_
 
 #include <ctime>
+#include <chrono>
 #include <unistd.h>
 #include <boost/lexical_cast.hpp>
 
@@ -63,6 +64,26 @@ namespace limbo {
     inline std::string getpid() {
       return boost::lexical_cast<std::string>(::getpid());
     }
+
+    // adds the wall-clock time spent in its scope (or until stop()) to t
+    // (in seconds)
+    class ScopedTimer {
+     public:
+      ScopedTimer(double& t) : _t(t), _running(true), _start(std::chrono::steady_clock::now()) {}
+      ~ScopedTimer() {
+        stop();
+      }
+      void stop() {
+        if (!_running)
+          return;
+        _t += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+        _running = false;
+      }
+     protected:
+      double& _t;
+      bool _running;
+      std::chrono::steady_clock::time_point _start;
+    };
   }
 }
 
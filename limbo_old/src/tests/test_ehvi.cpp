@@ -0,0 +1,150 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ehvi
+
+#include <boost/test/unit_test.hpp>
+
+#include "limbo/limbo.hpp"
+#include "limbo/ehvi.hpp"
+
+using namespace limbo;
+
+struct Params {
+  struct kf_maternfivehalfs {
+    BO_PARAM(double, sigma, 1);
+    BO_PARAM(double, l, 0.25);
+  };
+  struct meanconstant : public defaults::meanconstant {};
+  struct ehvi : public defaults::ehvi {};
+};
+
+// points on a sphere octant (mutually non-dominated)
+std::deque<individual*> make_front(size_t n) {
+  std::deque<individual*> pop;
+  for (size_t i = 0; i < n; ++i) {
+    double a = 1.5 * misc::rand<double>(), b = 1.5 * misc::rand<double>();
+    individual* ind = new individual;
+    ind->f[0] = 10 * cos(a) * cos(b);
+    ind->f[1] = 10 * sin(a) * cos(b);
+    ind->f[2] = 10 * sin(b);
+    pop.push_back(ind);
+  }
+  return pop;
+}
+
+BOOST_AUTO_TEST_CASE(test_ehvi3d_front) {
+  std::deque<individual*> pop = make_front(15);
+  double r[3] = {0, 0, 0};
+  ehvi3d_front front(pop, r);
+
+  std::vector<mus> pdf(20);
+  std::vector<mus*> ppdf;
+  for (size_t i = 0; i < pdf.size(); ++i) {
+    for (size_t d = 0; d < 3; ++d) {
+      pdf[i].mu[d] = 12 * misc::rand<double>();
+      pdf[i].s[d] = 0.1 + 3 * misc::rand<double>();
+    }
+    ppdf.push_back(&pdf[i]);
+  }
+  std::vector<double> batch = front.ehvi(ppdf);
+  for (size_t i = 0; i < pdf.size(); ++i) {
+    double ref = ehvi3d_sliceupdate(pop, r, pdf[i].mu, pdf[i].s);
+    BOOST_CHECK_CLOSE(front.ehvi(pdf[i].mu, pdf[i].s), ref, 1e-4);
+    BOOST_CHECK_CLOSE(batch[i], ref, 1e-4);
+  }
+  for (auto x : pop)
+    delete x;
+}
+
+BOOST_AUTO_TEST_CASE(test_ehvi_span) {
+  std::deque<individual*> pop = make_front(15);
+  // the points are read in place, with any stride
+  std::vector<double> objs;
+  for (auto x : pop)
+    objs.insert(objs.end(), x->f, x->f + 3);
+  frontspan span3 = { objs.data(), (int) pop.size(), 3 };
+  std::vector<double> objs2;
+  for (auto x : pop)
+    objs2.insert(objs2.end(), x->f, x->f + 2);
+  frontspan span2 = { objs2.data(), (int) pop.size(), 2 };
+
+  double r[3] = {0, 0, 0};
+  ehvi3d_front front(pop, r), front_span(span3, r);
+  BOOST_CHECK_EQUAL(front.cells().size(), front_span.cells().size());
+  for (size_t i = 0; i < 10; ++i) {
+    double mu[3], s[3];
+    for (size_t d = 0; d < 3; ++d) {
+      mu[d] = 12 * misc::rand<double>();
+      s[d] = 0.1 + 3 * misc::rand<double>();
+    }
+    BOOST_CHECK_EQUAL(front_span.ehvi(mu, s), front.ehvi(mu, s));
+    BOOST_CHECK_EQUAL(ehvi2d(span2, r, mu, s), ehvi2d(pop, r, mu, s));
+  }
+  for (auto x : pop)
+    delete x;
+}
+
+BOOST_AUTO_TEST_CASE(test_ehvi3d_montecarlo) {
+  std::deque<individual*> pop = make_front(15);
+  double r[3] = {0, 0, 0};
+  ehvi3d_front front(pop, r);
+
+  for (size_t i = 0; i < 10; ++i) {
+    double mu[3], s[3];
+    for (size_t d = 0; d < 3; ++d) {
+      mu[d] = 4 + 6 * misc::rand<double>();
+      s[d] = 0.5 + 2 * misc::rand<double>();
+    }
+    double mc = ehvi3d_montecarlo(front, mu, s, i, 0.002);
+    BOOST_CHECK_CLOSE(mc, front.ehvi(mu, s), 2);
+    // the estimate only depends on the stream
+    BOOST_CHECK_EQUAL(mc, ehvi3d_montecarlo(front, mu, s, i, 0.002));
+  }
+  for (auto x : pop)
+    delete x;
+}
+
+BOOST_AUTO_TEST_CASE(test_ehvi_3_objectives) {
+  typedef kernel_functions::MaternFiveHalfs<Params> KF_t;
+  typedef mean_functions::MeanConstant<Params> Mean_t;
+  typedef model::GP<Params, KF_t, Mean_t> GP_t;
+
+  std::vector<Eigen::VectorXd> samples;
+  std::vector<std::vector<double> > obs(3);
+  for (size_t i = 0; i < 10; ++i) {
+    Eigen::VectorXd v(2);
+    v << misc::rand<double>(), misc::rand<double>();
+    samples.push_back(v);
+    obs[0].push_back(v(0));
+    obs[1].push_back(1 - v(0));
+    obs[2].push_back(v(1));
+  }
+  std::vector<GP_t> models(3, GP_t(2));
+  for (size_t i = 0; i < 3; ++i)
+    models[i].compute(samples, obs[i], 0.01);
+
+  std::deque<individual*> pop = make_front(5);
+  // contiguous rows, as BoMulti::pareto_data_objs()
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> objs(pop.size(), 3);
+  for (size_t i = 0; i < pop.size(); ++i)
+    for (size_t d = 0; d < 3; ++d)
+      objs(i, d) = pop[i]->f[d] / 10;
+  frontspan span = { objs.data(), (int) objs.rows(), 3 };
+  Eigen::VectorXd ref(3);
+  ref << -1, -1, -1;
+  acquisition_functions::Ehvi<Params, GP_t> acqui(models, span, ref);
+
+  std::vector<Eigen::VectorXd> candidates;
+  for (size_t i = 0; i < 40; ++i) {
+    Eigen::VectorXd v(2);
+    v << misc::rand<double>(), misc::rand<double>();
+    candidates.push_back(v);
+  }
+  std::vector<double> batch = acqui.batch(candidates);
+  BOOST_CHECK_EQUAL(batch.size(), candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    BOOST_CHECK(batch[i] >= 0);
+    BOOST_CHECK_CLOSE(batch[i], acqui(candidates[i]), 1e-6);
+  }
+  for (auto x : pop)
+    delete x;
+}
@@ -26,22 +26,44 @@ def scale2(x, pos):
     'The two args are the value and tick position'
     return '%1.1f' % (x / 60.0)
 
+# usage: plot_map.py archive size [dim_x dim_y]
+# archive rows: cell index, descriptor, fitness, nb_params parameters;
+# the descriptor (4-D for gatest, 19-D for gatest_cvt) is projected on
+# the dimensions dim_x and dim_y (default: 0 and 1), each pixel shows the
+# best elite projected on it
+nb_params = 20
 size = int(sys.argv[2])
+dim_x = int(sys.argv[3]) if len(sys.argv) > 3 else 0
+dim_y = int(sys.argv[4]) if len(sys.argv) > 4 else 1
 
 print sys.argv[1]
-#data = np.loadtxt(sys.argv[1]).T
-k, x, y, z = np.loadtxt(sys.argv[1], unpack=True, usecols=(0,1,2,3))
+archive = np.atleast_2d(np.loadtxt(sys.argv[1]))
+dim = archive.shape[1] - 2 - nb_params
+if dim < 1:
+    sys.exit("%s: %d columns, expected the cell index, the descriptor, the fitness and %d parameters"
+             % (sys.argv[1], archive.shape[1], nb_params))
+if max(dim_x, dim_y) >= dim:
+    sys.exit("%s: %d-D descriptor, cannot plot dimensions %d and %d"
+             % (sys.argv[1], dim, dim_x, dim_y))
+x = archive[:, 1 + dim_x]
+y = archive[:, 1 + dim_y]
+z = archive[:, 1 + dim]
 data = np.zeros((size, size))
+filled = np.zeros((size, size), dtype=bool)
 m = 0
 x_m = 0
 y_m = 0
 for i in range(0, len(z)):
-    data[int(round(x[i] * size)), int(round(y[i] * size))] = z[i]
+    px = min(int(round(x[i] * size)), size - 1)
+    py = min(int(round(y[i] * size)), size - 1)
+    if not filled[px, py] or z[i] > data[px, py]:
+        data[px, py] = z[i]
+        filled[px, py] = True
     if z[i] > m:
-        x_m = round(x[i] * size)
-        y_m = round(y[i] * size)
+        x_m = px
+        y_m = py
         m = z[i]
-data = np.ma.masked_where(data == 0, data)
+data = np.ma.masked_where(np.logical_not(filled), data)
 
 print "best:"+str(max(z))
 
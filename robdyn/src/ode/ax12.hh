@@ -14,6 +14,9 @@ namespace ode
   public:
     typedef boost::shared_ptr<Ax12> ptr_t;
     BOOST_STATIC_CONSTEXPR float angular_vel = 150.0 / 1024.0 * 11.9;
+    // dead band of the position control: one AX-12 position step
+    // (300 degrees over 1024 steps)
+    BOOST_STATIC_CONSTEXPR double dead_band = 5.0 * M_PI / 3.0 / 1024.0;
     Ax12(Environment& env,
 	 const Eigen::Vector3d& anchor,
 	 Object& o1, Object& o2,
@@ -42,18 +45,16 @@ namespace ode
       dJointSetAMotorParam(_amotor, dParamFMax2, fmax);
       dJointSetAMotorParam(_amotor, dParamFMax3, fmax);
     }
+    // full speed towards the target outside the dead band (the error
+    // is compared in radians, without converting it to AX-12 steps)
     virtual void _asserv(unsigned i, float dt)
     {
-      double cur_angle1 = dJointGetAMotorAngle(_amotor, i);
-      double error1 = _angles(i) - cur_angle1 - _offset(i);
-      double error2 = error1 / (5.0 * M_PI/3.0) * 1024.0;
-      int sign = (error1 > 0) * 2 - 1;
+      double error = _angles(i) - dJointGetAMotorAngle(_amotor, i) - _offset(i);
       double vel = 0;
-
-      if(fabs(error2) > 1)
-	vel = angular_vel * sign;
-      else
-	vel = 0;
+      if (error > dead_band)
+	vel = angular_vel;
+      else if (error < -dead_band)
+	vel = -angular_vel;
       dJointSetAMotorParam(_amotor, _vel_selector(i), vel);
     }
   };
@@ -0,0 +1,51 @@
+#include "batch_environment.hh"
+
+namespace ode
+{
+  BatchEnvironment :: BatchEnvironment(size_t nb_slots, float spacing,
+                                       float pitch, float roll, float z) :
+    Environment(pitch, roll, z),
+    _spacing(spacing),
+    _active(nb_slots, true)
+  {
+    for (size_t k = 0; k < nb_slots; ++k)
+      _slots.push_back(boost::shared_ptr<Environment>(new Environment(sub_env_t(), *this)));
+  }
+
+  BatchEnvironment :: ~BatchEnvironment()
+  {
+     // the sub-spaces must be destroyed before the world
+    _slots.clear();
+  }
+
+  size_t BatchEnvironment :: nb_active() const
+  {
+    size_t n = 0;
+    for (size_t k = 0; k < _active.size(); ++k)
+      n += _active[k];
+    return n;
+  }
+
+  void BatchEnvironment :: disable_slot(size_t k)
+  {
+    if (!_active[k])
+      return;
+    _active[k] = false;
+    dSpaceID space = _slots[k]->get_space();
+    for (int i = 0; i < dSpaceGetNumGeoms(space); ++i)
+    {
+      dBodyID b = dGeomGetBody(dSpaceGetGeom(space, i));
+      if (b)
+        dBodyDisable(b);
+    }
+  }
+
+  void BatchEnvironment :: next_step(double dt)
+  {
+    for (size_t k = 0; k < _slots.size(); ++k)
+      if (_active[k])
+        _slots[k]->collide();
+    dWorldStep(_world_id, dt);
+    dJointGroupEmpty(_contactgroup);
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef         BATCH_ENVIRONMENT_HH_
+# define        BATCH_ENVIRONMENT_HH_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <Eigen/Core>
+#include "environment.hh"
+
+namespace ode
+{
+   /// several independent simulations in a single world: each slot is a
+   /// sub-environment with its own collision space (its robot and its
+   /// blocks), translated by offset(k) along y; the slots are never
+   /// collided with each other, only with the shared ground, so one
+   /// dWorldStep advances all of them. Disabled slots (e.g. a robot
+   /// that flipped) are no longer collided nor integrated.
+   ///
+   /// The slots only see the same terrain if the ground is invariant
+   /// along y, i.e. for a pitch (rotation around x) of 0.
+  class BatchEnvironment : public Environment
+  {
+    public:
+      BatchEnvironment(size_t nb_slots, float spacing,
+                       float pitch = 0, float roll = 0, float z = 0);
+      ~BatchEnvironment();
+
+      size_t nb_slots() const { return _slots.size(); }
+      Environment& slot(size_t k) { return *_slots[k]; }
+      const Environment& slot(size_t k) const { return *_slots[k]; }
+       /// translation from the origin of the world to the origin of slot k
+      Eigen::Vector3d offset(size_t k) const
+      {
+        return Eigen::Vector3d(0, k * _spacing, 0);
+      }
+      bool active(size_t k) const { return _active[k]; }
+      size_t nb_active() const;
+       /// disables the bodies of the slot: they are frozen and ignored by
+       /// the next steps (the slot cannot be enabled again)
+      void disable_slot(size_t k);
+       /// one step for all the active slots
+      void next_step(double dt = time_step);
+    protected:
+      float _spacing;
+      std::vector<boost::shared_ptr<Environment> > _slots;
+      std::vector<bool> _active;
+  };
+}
+
+#endif      /* !BATCH_ENVIRONMENT_HH_ */
@@ -30,10 +30,73 @@ namespace ode
 {
   void Environment::add_to_ground(ode::Object& o)
   {
-    _ground_objects.insert(o.get_geom());
+    _set_group(o.get_geom(), ground_group);
+  }
+  void Environment::set_max_contacts(int n)
+  {
+    assert(n >= 1 && n <= max_contacts);
+    std::fill(&_max_contacts[0][0],
+              &_max_contacts[0][0] + dGeomNumClasses * dGeomNumClasses, n);
+  }
+  void Environment::set_max_contacts(int c1, int c2, int n)
+  {
+    assert(n >= 1 && n <= max_contacts);
+    assert(c1 >= 0 && c1 < dGeomNumClasses && c2 >= 0 && c2 < dGeomNumClasses);
+    _max_contacts[c1][c2] = n;
+    _max_contacts[c2][c1] = n;
+  }
+  int Environment::_collide(dGeomID o1, dGeomID o2, dContact* contact) const
+  {
+    int n = dCollide(o1, o2, get_max_contacts(o1, o2),
+                     &contact[0].geom, sizeof(dContact));
+    if (_merge_dist <= 0 || n < 2)
+      return n;
+     // greedy clustering: each contact is merged into the first kept
+     // contact closer than _merge_dist (mean position and normal,
+     // deepest penetration)
+    int weight[max_contacts];
+    int k = 0;
+    for (int i = 0; i < n; ++i)
+    {
+      dContactGeom& c = contact[i].geom;
+      int j = 0;
+      for (; j < k; ++j)
+      {
+        const dContactGeom& m = contact[j].geom;
+        dReal d2 = 0;
+        for (int a = 0; a < 3; ++a)
+          d2 += (c.pos[a] - m.pos[a]) * (c.pos[a] - m.pos[a]);
+        if (d2 < _merge_dist * _merge_dist)
+          break;
+      }
+      if (j == k)
+      {
+        contact[k].geom = c;
+        weight[k++] = 1;
+        continue;
+      }
+      dContactGeom& m = contact[j].geom;
+      int w = weight[j]++;
+      dReal norm = 0;
+      for (int a = 0; a < 3; ++a)
+      {
+        m.pos[a] = (m.pos[a] * w + c.pos[a]) / (w + 1);
+        m.normal[a] = m.normal[a] * w + c.normal[a];
+        norm += m.normal[a] * m.normal[a];
+      }
+      norm = sqrt(norm);
+      if (norm > 0)
+        for (int a = 0; a < 3; ++a)
+          m.normal[a] /= norm;
+      m.depth = std::max(m.depth, c.depth);
+    }
+    return k;
   }
   void Environment::_init(bool add_ground, float _angle)
   {
+    init_thread();
+    _merge_dist = 0;
+    set_max_contacts(max_contacts);
      //create world
     _world_id = dWorldCreate();
      //init gravity
@@ -50,7 +113,7 @@ namespace ode
       q2 = Eigen::AngleAxis<float>(_roll, Eigen::Vector3f::UnitY());
       normal = q2 * q1 * normal;
       _ground = dCreatePlane(_space_id, normal.x(), normal.y(), normal.z(), _z);
-      _ground_objects.insert(_ground);
+      _set_group(_ground, ground_group);
     }
      //contact group1
     _contactgroup = dJointGroupCreate(0);
@@ -66,31 +129,31 @@ namespace ode
   }
   void Environment::_collision(dGeomID o1, dGeomID o2)
   {
-    int g1 = (_ground_objects.find(o1) != _ground_objects.end());
-    int g2 = (_ground_objects.find(o2) != _ground_objects.end());
+    int g1 = (_group(o1) == ground_group);
+    int g2 = (_group(o2) == ground_group);
 
     if (!(g1 ^ g2))
       return;
 
-    static const int N = 10;
     int i, n;
-    dContact contact[N];
-    n = dCollide(o1, o2, N, &contact[0].geom, sizeof(dContact));
+    dContact contact[max_contacts];
+    n = _collide(o1, o2, contact);
 
-    dBodyID b = 0;
-    if (g1 && o2)
-      b = dGeomGetBody(o2);
-    else
-    if (o1)
-      b = dGeomGetBody(o1);
-    if (b)
-    {
-      Object*o = (Object *)dBodyGetData(b);
-      if (dBodyGetData(b))
-        o->set_in_contact(true);
-    }
     if (n > 0)
     {
+      // only actual contacts count (the ground plane overlaps every AABB)
+      dBodyID b = 0;
+      if (g1 && o2)
+        b = dGeomGetBody(o2);
+      else
+      if (o1)
+        b = dGeomGetBody(o1);
+      if (b)
+      {
+        Object*o = (Object *)dBodyGetData(b);
+        if (dBodyGetData(b))
+          o->set_in_contact(true);
+      }
       for (i = 0; i < n; i++)
       {
         contact[i].surface.mode = dContactSlip1 | dContactSlip2 |
@@ -27,42 +27,58 @@
 #include <boost/config.hpp>
 #include <ode/ode.h>
 #include <ode/common.h>
-#include <set>
+#include <stdint.h>
+#include <algorithm>
 #include "misc.hh"
+#include "threading.hh"
 
 namespace ode
 {
   class Object;
-   //singleton : only one env
+   /// a world, its collision space and its ground; confined to one thread
+   /// at a time (see threading.hh)
   class Environment
   {
     public:
       BOOST_STATIC_CONSTEXPR float time_step = 0.05;
+      /// maximum number of contacts between two geoms (the caps set by
+      /// set_max_contacts() cannot be higher)
+      BOOST_STATIC_CONSTEXPR int max_contacts = 10;
+       /// tag of the sub-environment constructor (see BatchEnvironment)
+      struct sub_env_t {};
        // constructor
     Environment() :
-        _ground(0x0), _pitch(0), _roll(0), _z(0)
+        _ground(0x0), _parent(0), _pitch(0), _roll(0), _z(0)
       {
         _init(true);
       }
     Environment(float angle) :
-        _ground(0x0), _pitch(0), _roll(0), _z(0)
+        _ground(0x0), _parent(0), _pitch(0), _roll(0), _z(0)
       {
         _init(true,angle);
       }
     Environment(float pitch, float roll, float z) :
-        _ground(0x0), _pitch(pitch), _roll(roll), _z(z)
+        _ground(0x0), _parent(0), _pitch(pitch), _roll(roll), _z(z)
       {
         _init(true);
       }
 
     Environment(bool add_ground) :
-        _ground(0x0), _pitch(0), _roll(0), _z(0)
+        _ground(0x0), _parent(0), _pitch(0), _roll(0), _z(0)
       {
         _init(add_ground);
       }
+       /// an environment owns its ODE world; sub-environments are made
+       /// with Environment(sub_env_t(), parent)
+    Environment(const Environment&) = delete;
+    Environment& operator=(const Environment&) = delete;
      ~Environment()
       {
-
+        if (_parent)
+        {
+          dSpaceDestroy(get_space());
+          return;
+        }
         if (_ground)
           dGeomDestroy(_ground);
         dSpaceDestroy(get_space());
@@ -90,12 +106,21 @@ namespace ode
       void next_step(double dt = time_step)
       {
          //check collisions
-        dSpaceCollide(_space_id, (void *)this, &_near_callback);
+        collide();
          //next step
         dWorldStep(_world_id, dt);
          //dWorldQuickStep(_world_id, dt);
          // remove all contact joints
         dJointGroupEmpty(_contactgroup);
+      }
+       /// creates the contact joints of this environment for the next
+       /// step (a sub-environment also collides with the ground of its
+       /// parent)
+      void collide()
+      {
+        dSpaceCollide(_space_id, (void *)this, &_near_callback);
+        if (_parent && _ground)
+          dSpaceCollide2((dGeomID)_space_id, _ground, (void *)this, &_near_callback);
       }
       void disable_gravity()
       {
@@ -106,13 +131,59 @@ namespace ode
         dWorldSetGravity(_world_id, x, y, z);
       }
       void add_to_ground(ode::Object& o);
+       /// contact budget: at most n contacts (1 <= n <= max_contacts)
+       /// for every pair of geoms, or for the pairs of geoms of the
+       /// classes c1 and c2 (dPlaneClass, dBoxClass, dCapsuleClass...),
+       /// e.g. a capsule on a plane needs 2 contacts, not 10
+      void set_max_contacts(int n);
+      void set_max_contacts(int c1, int c2, int n);
+      int get_max_contacts(dGeomID o1, dGeomID o2) const
+      {
+        return _max_contacts[dGeomGetClass(o1)][dGeomGetClass(o2)];
+      }
+       /// contacts of a pair closer than dist are merged into one (0, the
+       /// default, disables merging)
+      void set_contact_merging(float dist) { _merge_dist = dist; }
+      float get_contact_merging() const { return _merge_dist; }
       float get_pitch() const { return _pitch; }
       float get_roll() const { return _roll; }
       float get_z() const { return _z; }
     protected:
-      std::set<dGeomID> _ground_objects;
-      std::set<dGeomID> _ground_objects_blocks;
+       /// sub-environment (see BatchEnvironment): shares the world, the
+       /// ground and the contact group of parent, and has its own collision
+       /// space, which is not collided with the other sub-environments
+      friend class BatchEnvironment;
+      Environment(sub_env_t, const Environment& parent) :
+        _ground(parent._ground), _parent(&parent),
+        _pitch(parent._pitch), _roll(parent._roll), _z(parent._z),
+        angle(parent.angle), _merge_dist(parent._merge_dist)
+      {
+        std::copy(&parent._max_contacts[0][0],
+                  &parent._max_contacts[0][0] + dGeomNumClasses * dGeomNumClasses,
+                  &_max_contacts[0][0]);
+        init_thread();
+        _world_id = parent._world_id;
+        _space_id = dHashSpaceCreate(0);
+        _contactgroup = parent._contactgroup;
+      }
+       /// collision group of a geom, stored in its user data so that the
+       /// collision callbacks classify a geom without any lookup:
+       /// robot_group by default, ground_group for the ground and the
+       /// objects added to it, leg_group + i for the objects of leg i
+       /// (Environment_hexa)
+      enum { robot_group = 0, ground_group = 1, leg_group = 2 };
+      static void _set_group(dGeomID g, int group)
+      {
+        dGeomSetData(g, reinterpret_cast<void*>(static_cast<intptr_t>(group)));
+      }
+      static int _group(dGeomID g)
+      {
+        return static_cast<int>(reinterpret_cast<intptr_t>(dGeomGetData(g)));
+      }
     void _init(bool add_ground,float angle=0);
+       /// contacts between o1 and o2 (at most get_max_contacts(), merged
+       /// if set_contact_merging() was called); returns their number
+      int _collide(dGeomID o1, dGeomID o2, dContact* contact) const;
       static void _near_callback(void *data, dGeomID o1, dGeomID o2)
       {
         Environment*env = reinterpret_cast<Environment *>(data);
@@ -124,9 +195,12 @@ namespace ode
       dWorldID _world_id;
       dSpaceID _space_id;
       dGeomID _ground;
+      const Environment* _parent;
       dJointGroupID _contactgroup;
       float _pitch, _roll, _z;
     float angle;
+      int _max_contacts[dGeomNumClasses][dGeomNumClasses];
+      float _merge_dist;
   };
 }
 
@@ -31,67 +31,14 @@ namespace ode
 {
   void Environment_hexa::add_leg_object(int leg,ode::Object& o)
   {
-      switch(leg)
-	{
-	case 0:
-	  _leg0_objects.insert(o.get_geom());
-	  break;
-	case 1:
-	  _leg1_objects.insert(o.get_geom());
-	  break;
-	case 2:
-	  _leg2_objects.insert(o.get_geom());
-	  break;
-	case 3:
-	  _leg3_objects.insert(o.get_geom());
-	  break;
-	case 4:
-	  _leg4_objects.insert(o.get_geom());
-	  break;
-	case 5:
-	  _leg5_objects.insert(o.get_geom());
-	  break;
-	}
-    }
+    assert(leg >= 0 && leg < 6);
+    _set_group(o.get_geom(), leg_group + leg);
+  }
 
    void Environment_hexa::_collision(dGeomID o1, dGeomID o2)
   {
-
-
-    int g1 ;
-    if(_ground_objects.find(o1) != _ground_objects.end())
-      g1=-1;
-    else if(_leg0_objects.find(o1) != _leg0_objects.end())
-      g1=0;
-    else if(_leg1_objects.find(o1) != _leg1_objects.end())
-      g1=1;
-    else if(_leg2_objects.find(o1) != _leg2_objects.end())
-      g1=2;
-    else if(_leg3_objects.find(o1) != _leg3_objects.end())
-      g1=3;
-    else if(_leg4_objects.find(o1) != _leg4_objects.end())
-      g1=4;
-    else if(_leg5_objects.find(o1) != _leg5_objects.end())
-      g1=5;
-    else
-      g1=6; //main body
-    int g2 ;
-    if(_ground_objects.find(o2) != _ground_objects.end()) //ground
-      g2=-1;
-    else if(_leg0_objects.find(o2) != _leg0_objects.end())
-      g2=0;
-    else if(_leg1_objects.find(o2) != _leg1_objects.end())
-      g2=1;
-    else if(_leg2_objects.find(o2) != _leg2_objects.end())
-      g2=2;
-    else if(_leg3_objects.find(o2) != _leg3_objects.end())
-      g2=3;
-    else if(_leg4_objects.find(o2) != _leg4_objects.end())
-      g2=4;
-    else if(_leg5_objects.find(o2) != _leg5_objects.end())
-      g2=5;
-    else
-      g2=6; // main body
+    int g1 = _hexa_group(o1);
+    int g2 = _hexa_group(o2);
 
     //if (!(g1==-1 ^ g2==-1))
     // return;
@@ -101,10 +48,9 @@ namespace ode
 
 
 
-    static const int N = 10;
     int i, n;
-    dContact contact[N];
-    n = dCollide(o1, o2, N, &contact[0].geom, sizeof(dContact));
+    dContact contact[max_contacts];
+    n = _collide(o1, o2, contact);
 
     /*dBodyID b = 0;  //don't work anymore with collision between leg detection
     if (g1 && o2)
@@ -51,13 +51,6 @@ namespace ode
       _colision_between_legs(false)
       {
         _init(true,env.angle);
-	_leg0_objects=env._leg0_objects;
-	_leg1_objects=env._leg1_objects;
-	_leg2_objects=env._leg2_objects;
-	_leg3_objects=env._leg3_objects;
-	_leg4_objects=env._leg4_objects;
-	_leg5_objects=env._leg5_objects;
-    
       }
     
 
@@ -66,12 +59,16 @@ namespace ode
     bool get_colision_between_legs(){return _colision_between_legs;}
   protected:
     void _collision(dGeomID o1, dGeomID o2);
-    std::set<dGeomID> _leg0_objects;
-    std::set<dGeomID> _leg1_objects;
-    std::set<dGeomID> _leg2_objects;
-    std::set<dGeomID> _leg3_objects;
-    std::set<dGeomID> _leg4_objects;
-    std::set<dGeomID> _leg5_objects;
+    // -1 for the ground, 0-5 for the legs, 6 for the main body
+    static int _hexa_group(dGeomID g)
+    {
+      int group = _group(g);
+      if (group == ground_group)
+        return -1;
+      if (group == robot_group)
+        return 6;
+      return group - leg_group;
+    }
     bool _colision_between_legs ;
   
  
@@ -24,6 +24,8 @@
 # define        OBJECT_HH_
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include <assert.h>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -76,6 +78,40 @@ namespace ode
        /// Cf ode documentation for details
       Eigen::Vector3d get_pos()   const { return _get_ode_pos(); }
       Eigen::Vector3d get_rot() const;
+       /// z axis of the body in world coordinates, read from the rotation
+       /// matrix (like the tilt tests below, cheap enough to be called at
+       /// every step, unlike the Euler angles of get_rot())
+      Eigen::Vector3d get_up() const
+      {
+        const dReal* r = dBodyGetRotation(get_body());
+        return Eigen::Vector3d(r[2], r[6], r[10]);
+      }
+       /// rotation matrix of the body (no trigonometry)
+      Eigen::Matrix3d get_rotation() const
+      {
+        const dReal* r = dBodyGetRotation(get_body());
+        Eigen::Matrix3d m;
+        m << r[0], r[1], r[2], r[4], r[5], r[6], r[8], r[9], r[10];
+        return m;
+      }
+       /// angle between the z axes of the body and of the world
+      float get_tilt() const
+      {
+        const dReal* r = dBodyGetRotation(get_body());
+        return acos(std::max(-1.0, std::min(1.0, (double)r[10])));
+      }
+       /// true if the tilt is greater than max_tilt (no trigonometry
+       /// when max_tilt is a constant)
+      bool tilted(float max_tilt) const
+      {
+        return dBodyGetRotation(get_body())[10] < cos(max_tilt);
+      }
+       /// tilt greater than 90 degrees, i.e. |roll| of get_rot() greater
+       /// than 90 degrees
+      bool upside_down() const
+      {
+        return dBodyGetRotation(get_body())[10] < 0;
+      }
       Eigen::Vector3d get_vel() const { return get_vground(); }
        /// set an absolute rotation (euler angles)
       void set_rotation(float phi, float theta, float psi)
@@ -96,6 +132,12 @@ namespace ode
         dMatrix3 r;
 	dRFrom2Axes (r, a1.x(), a1.y(), a1.z(), a2.x(), a2.y(), a2.z());
         dBodySetRotation(get_body(), r);
+      }
+       /// move the body by d (world frame), without changing its rotation
+      void translate(const Eigen::Vector3d& d)
+      {
+        const dReal* p = dBodyGetPosition(get_body());
+        dBodySetPosition(get_body(), p[0] + d.x(), p[1] + d.y(), p[2] + d.z());
       }
        /// const visitor, useful for example for a 3d renderer
       virtual void accept(ConstVisitor& v) const = 0;
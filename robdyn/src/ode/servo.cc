@@ -81,7 +81,9 @@ namespace ode
     _lim_max(o._lim_max),
     _blocked(o._blocked),
     _p(o._p),
-    _offset(o._offset)
+    _offset(o._offset),
+    _gain(o._gain),
+    _gain_dt(o._gain_dt)
   {
     if(!init)
       return;
@@ -139,11 +141,10 @@ namespace ode
 
   void Servo :: _asserv(unsigned i, float dt)
   {
-     //std::cout<<"\nServo::_asserv   dt ="<<dt<<"\n";
-    static const float gain = 1.0 / (M_PI * dt);
+     // _gain is updated by next_step() when dt changes
     float pos = dJointGetAMotorAngle(_amotor, i);
     float error = pos - _angles(i) - _offset[i];
-    float vel = -error * gain * _p;
+    float vel = -error * _gain * _p;
  //   if (vel > 1)//cap velocity
  //     vel = 1;
  //   if (vel < -1)
@@ -156,8 +157,11 @@ namespace ode
     if (!_blocked)
     {
       if (_mode == M_POS)
+      {
+        _update_gain(dt);
         for (unsigned i = 0; i < _angles.size(); ++i)
           _asserv(i, dt);
+      }
       else
         for (unsigned i = 0; i < _vel.size(); ++i)
           if ((_vel(i) < 0 && get_angle(i) > _lim_min(i)) ||
@@ -167,22 +171,8 @@ namespace ode
             dJointSetAMotorParam(_amotor, _vel_selector(i), 0);
     }
 
-     //probably useless
-    dJointGetFeedback(_amotor);
-
-    const dReal*r1 = dBodyGetAngularVel(_o1.get_body());
-    Eigen::Vector3d v1(r1[0], r1[1], r1[2]);
-    const dReal*r2 = dBodyGetAngularVel(_o2.get_body());
-    Eigen::Vector3d v2(r2[0], r2[1], r2[2]);
-    /*dVector3 p;
-      dJointGetBallAnchor(_ball, p);
-    Eigen::Vector3d pos(p[0], p[1], p[2]);
-    Eigen::Vector3d v = v1 - v2;
-    */
-
-     //get torques
+     //get torques (_feedback is filled by ODE at each step)
     Eigen::Vector3d t1(_feedback.t1[0], _feedback.t1[1], _feedback.t1[2]);
-    Eigen::Vector3d t2(_feedback.t2[0], _feedback.t2[1], _feedback.t2[2]);
     _torque=t1.norm();
 
     /*
@@ -38,7 +38,9 @@ namespace ode
         _lim_max(Eigen::Vector3d::Constant(DEFAULT_STOP)),
         _blocked(false),
         _p(1.0),
-        _offset(Eigen::Vector3d::Zero())
+        _offset(Eigen::Vector3d::Zero()),
+        _gain(0),
+        _gain_dt(0)
       {
 	if( init)
 	  _init();
@@ -162,6 +164,17 @@ namespace ode
       bool _blocked;
       float _p;
       Eigen::Vector3d _offset;
+       // gain of the P loop, for a time step of _gain_dt
+      float _gain;
+      float _gain_dt;
+      void _update_gain(float dt)
+      {
+        if (dt != _gain_dt)
+        {
+          _gain = 1.0 / (M_PI * dt);
+          _gain_dt = dt;
+        }
+      }
   };
 }
 
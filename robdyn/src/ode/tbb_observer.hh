@@ -0,0 +1,28 @@
+#ifndef         ODE_TBB_OBSERVER_HH_
+# define        ODE_TBB_OBSERVER_HH_
+
+#include <tbb/task_scheduler_observer.h>
+#include "threading.hh"
+
+namespace ode
+{
+  /// allocates the ODE data of each TBB worker when it joins the
+  /// scheduler and releases it when the worker leaves (see threading.hh);
+  /// create one before the first parallel loop, e.g. in main()
+  class ThreadObserver : public tbb::task_scheduler_observer
+  {
+    public:
+      ThreadObserver() { observe(true); }
+      ~ThreadObserver() { observe(false); }
+      void on_scheduler_entry(bool /*is_worker*/) { init_thread(); }
+      /// the main thread keeps its data (its environments outlive the
+      /// parallel loops)
+      void on_scheduler_exit(bool is_worker)
+      {
+        if (is_worker)
+          cleanup_thread();
+      }
+  };
+}
+
+#endif      /* !ODE_TBB_OBSERVER_HH_ */
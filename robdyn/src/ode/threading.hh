@@ -0,0 +1,63 @@
+#ifndef         ODE_THREADING_HH_
+# define        ODE_THREADING_HH_
+
+#include <ode/ode.h>
+
+/// Threading in robdyn
+///
+/// ODE >= 0.12 keeps per-thread data (collision caches, ...) that must
+/// be allocated in every thread that uses ODE, otherwise worlds created
+/// from worker threads share or miss this data (the crashes that pinned
+/// ODE <= 0.11.1). ode::init() replaces dInitODE2() in the main thread;
+/// Environment allocates the data of the calling thread the first time
+/// it is constructed in this thread, so any threading backend works.
+/// With TBB, ode::ThreadObserver (tbb_observer.hh) also releases the data
+/// when the workers leave the scheduler.
+///
+/// Thread confinement:
+/// - an Environment and everything created in it (Object, Servo, Motor,
+///   Robot) must only be used by one thread at a time
+/// - Robot::clone(env) only reads the source robot, so a template robot
+///   can be cloned concurrently from several threads as long as nobody
+///   steps or modifies it
+/// - robdyn has no mutable global or static state (function-local
+///   statics are constants that do not depend on the call)
+namespace ode
+{
+  inline bool& _thread_ready()
+  {
+    static thread_local bool ready = false;
+    return ready;
+  }
+  /// allocates the ODE data of the calling thread (once per thread)
+  inline void init_thread()
+  {
+    if (!_thread_ready())
+    {
+      dAllocateODEDataForThread(dAllocateMaskAll);
+      _thread_ready() = true;
+    }
+  }
+  /// releases the ODE data of the calling thread (no ODE object must be
+  /// used in this thread afterwards, unless init_thread() is called again)
+  inline void cleanup_thread()
+  {
+    if (_thread_ready())
+    {
+      dCleanupODEAllDataForThread();
+      _thread_ready() = false;
+    }
+  }
+  /// to be called once, in the main thread, instead of dInitODE2()
+  inline void init()
+  {
+    dInitODE2(0);
+    init_thread();
+  }
+  inline void close()
+  {
+    dCloseODE();
+  }
+}
+
+#endif      /* !ODE_THREADING_HH_ */
@@ -0,0 +1,288 @@
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include "description.hh"
+
+namespace robot
+{
+    namespace
+    {
+        /// recursive descent evaluation of +, -, *, /, parentheses,
+        /// numbers and params
+        class Expr
+        {
+            public:
+                Expr(const std::string& s, const Description::params_t& params) :
+                    _s(s), _p(0), _params(params) {}
+                double eval()
+                {
+                    double v = _sum();
+                    if (_p != _s.size())
+                        _error("unexpected '" + _s.substr(_p) + "'");
+                    return v;
+                }
+            protected:
+                const std::string& _s;
+                size_t _p;
+                const Description::params_t& _params;
+
+                void _error(const std::string& msg) const
+                {
+                    throw std::runtime_error("in expression '" + _s + "': " + msg);
+                }
+                double _sum()
+                {
+                    double v = _product();
+                    while (_p < _s.size() && (_s[_p] == '+' || _s[_p] == '-'))
+                        v = _s[_p++] == '+' ? v + _product() : v - _product();
+                    return v;
+                }
+                double _product()
+                {
+                    double v = _unary();
+                    while (_p < _s.size() && (_s[_p] == '*' || _s[_p] == '/'))
+                        v = _s[_p++] == '*' ? v * _unary() : v / _unary();
+                    return v;
+                }
+                double _unary()
+                {
+                    if (_p < _s.size() && _s[_p] == '-')
+                    {
+                        ++_p;
+                        return -_unary();
+                    }
+                    if (_p < _s.size() && _s[_p] == '+')
+                        ++_p;
+                    return _atom();
+                }
+                double _atom()
+                {
+                    if (_p >= _s.size())
+                        _error("value expected");
+                    if (_s[_p] == '(')
+                    {
+                        ++_p;
+                        double v = _sum();
+                        if (_p >= _s.size() || _s[_p] != ')')
+                            _error("')' expected");
+                        ++_p;
+                        return v;
+                    }
+                    if (std::isdigit(_s[_p]) || _s[_p] == '.')
+                    {
+                        const char* begin = _s.c_str() + _p;
+                        char* end = 0;
+                        double v = strtod(begin, &end);
+                        _p += end - begin;
+                        return v;
+                    }
+                    size_t b = _p;
+                    while (_p < _s.size() && (std::isalnum(_s[_p]) || _s[_p] == '_'))
+                        ++_p;
+                    if (b == _p)
+                        _error(std::string("unexpected '") + _s[_p] + "'");
+                    std::string name = _s.substr(b, _p - b);
+                    if (name == "pi")
+                        return M_PI;
+                    Description::params_t::const_iterator it = _params.find(name);
+                    if (it == _params.end())
+                        _error("unknown param '" + name + "'");
+                    return it->second;
+                }
+        };
+
+        /// tokens of a statement (the first one is the keyword)
+        class Statement
+        {
+            public:
+                Statement(const std::vector<std::string>& tok,
+                          const Description::params_t& params) :
+                    _tok(tok), _k(1), _params(params) {}
+                const std::string& word()
+                {
+                    if (_k >= _tok.size())
+                        throw std::runtime_error("unexpected end of line");
+                    return _tok[_k++];
+                }
+                double value() { return Expr(word(), _params).eval(); }
+                Eigen::Vector3d vec()
+                {
+                    double x = value(), y = value(), z = value();
+                    return Eigen::Vector3d(x, y, z);
+                }
+                void expect(const std::string& w)
+                {
+                    if (word() != w)
+                        throw std::runtime_error("'" + w + "' expected");
+                }
+                bool next_is(const std::string& w)
+                {
+                    if (_k < _tok.size() && _tok[_k] == w)
+                    {
+                        ++_k;
+                        return true;
+                    }
+                    return false;
+                }
+                void end() const
+                {
+                    if (_k != _tok.size())
+                        throw std::runtime_error("unexpected '" + _tok[_k] + "'");
+                }
+            protected:
+                const std::vector<std::string>& _tok;
+                size_t _k;
+                const Description::params_t& _params;
+        };
+
+        int _body_type(const std::string& t)
+        {
+            if (t == "box")
+                return Description::BOX;
+            if (t == "capped_cyl")
+                return Description::CAPPED_CYL;
+            if (t == "sphere")
+                return Description::SPHERE;
+            throw std::runtime_error("unknown body type '" + t + "'");
+        }
+
+        int _servo_type(const std::string& t)
+        {
+            if (t == "servo")
+                return Description::SERVO;
+            if (t == "ax12")
+                return Description::AX12;
+            if (t == "mx28")
+                return Description::MX28;
+            if (t == "mx64")
+                return Description::MX64;
+            if (t == "mx106")
+                return Description::MX106;
+            throw std::runtime_error("unknown servo type '" + t + "'");
+        }
+
+        // same values as ode::Servo::DIHEDRAL, SWEEP, TWIST
+        int _axis_index(const std::string& a)
+        {
+            if (a == "dihedral")
+                return 0;
+            if (a == "sweep")
+                return 1;
+            if (a == "twist")
+                return 2;
+            throw std::runtime_error("unknown axis '" + a + "'");
+        }
+    }
+
+    Description :: Description(const std::string& fname, const params_t& overrides) :
+        _main_body(0)
+    {
+        std::ifstream ifs(fname.c_str());
+        if (!ifs.good())
+            throw std::runtime_error("cannot open " + fname);
+        parse(ifs, overrides, fname);
+    }
+
+    size_t Description :: body_index(const std::string& name) const
+    {
+        for (size_t i = 0; i < _bodies.size(); ++i)
+            if (_bodies[i].name == name)
+                return i;
+        throw std::runtime_error("unknown body '" + name + "'");
+    }
+
+    void Description :: parse(std::istream& is, const params_t& overrides,
+                              const std::string& fname)
+    {
+        _bodies.clear();
+        _servos.clear();
+        _params = overrides;
+        std::set<std::string> declared;
+        std::string main_body;
+        std::string line;
+        for (size_t l = 1; std::getline(is, line); ++l)
+        {
+            size_t c = line.find('#');
+            if (c != std::string::npos)
+                line.erase(c);
+            std::vector<std::string> tok;
+            std::istringstream iss(line);
+            for (std::string t; iss >> t; )
+                tok.push_back(t);
+            if (tok.empty())
+                continue;
+
+            try
+            {
+                Statement r(tok, _params);
+
+                if (tok[0] == "param")
+                {
+                    std::string name = r.word();
+                    double v = r.value();
+                    declared.insert(name);
+                    if (!overrides.count(name))
+                        _params[name] = v;
+                }
+                else if (tok[0] == "body")
+                {
+                    body_t b;
+                    b.name = r.word();
+                    b.type = _body_type(r.word());
+                    b.mass = r.value();
+                    b.size = Eigen::Vector3d::Zero();
+                    size_t nb_dims = b.type == BOX ? 3 : b.type == CAPPED_CYL ? 2 : 1;
+                    for (size_t i = 0; i < nb_dims; ++i)
+                        b.size[i] = r.value();
+                    r.expect("at");
+                    b.pos = r.vec();
+                    b.rotated = r.next_is("rot");
+                    b.rot = Eigen::Vector3d::Zero();
+                    if (b.rotated)
+                        b.rot = r.vec();
+                    _bodies.push_back(b);
+                }
+                else if (tok[0] == "servo")
+                {
+                    servo_t s;
+                    s.type = _servo_type(r.word());
+                    s.o1 = body_index(r.word());
+                    s.o2 = body_index(r.word());
+                    r.expect("at");
+                    s.anchor = r.vec();
+                    while (r.next_is("axis"))
+                    {
+                        axis_t a;
+                        a.index = _axis_index(r.word());
+                        a.dir = r.vec();
+                        s.axes.push_back(a);
+                    }
+                    _servos.push_back(s);
+                }
+                else if (tok[0] == "main")
+                    main_body = r.word();
+                else
+                    throw std::runtime_error("unknown statement '" + tok[0] + "'");
+                r.end();
+            }
+            catch (const std::runtime_error& e)
+            {
+                std::ostringstream oss;
+                oss << fname << ":" << l << ": " << e.what();
+                throw std::runtime_error(oss.str());
+            }
+        }
+        // a misspelled override would silently leave the param unchanged
+        for (params_t::const_iterator it = overrides.begin(); it != overrides.end(); ++it)
+            if (!declared.count(it->first))
+                throw std::runtime_error(fname + ": override of '" + it->first
+                                         + "', which has no param line");
+        if (_bodies.empty())
+            throw std::runtime_error(fname + ": no body");
+        _main_body = main_body.empty() ? 0 : body_index(main_body);
+    }
+}
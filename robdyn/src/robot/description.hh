@@ -0,0 +1,86 @@
+#ifndef ROBOT_DESCRIPTION_HPP
+#define ROBOT_DESCRIPTION_HPP
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+namespace robot
+{
+    /// Declarative description of a robot (bodies and servos), read from
+    /// a text file. Parsing evaluates every expression and resolves every
+    /// name, so a loaded description is a template that can be
+    /// instantiated in any number of environments (see robot::Generic)
+    /// without being parsed again.
+    ///
+    /// One statement per line, '#' starts a comment. Values are
+    /// expressions written without spaces (numbers, params, pi, + - * /
+    /// and parentheses); positions are relative to the position given at
+    /// instantiation, angles are in radians:
+    ///   param <name> <expr>
+    ///   body <name> box <mass> <l> <w> <h> at <x> <y> <z> [rot <phi> <theta> <psi>]
+    ///   body <name> capped_cyl <mass> <radius> <length> at <x> <y> <z> [rot ...]
+    ///   body <name> sphere <mass> <radius> at <x> <y> <z> [rot ...]
+    ///   servo <servo|ax12|mx28|mx64|mx106> <body1> <body2> at <x> <y> <z>
+    ///         [axis <dihedral|sweep|twist> <x> <y> <z>]...
+    ///   main <body>   (default: the first body)
+    /// Bodies and servos keep the order of the file. Params can be
+    /// overridden when loading (morphology sweeps), an overridden param
+    /// line is ignored; overriding a param without a param line is an
+    /// error.
+    class Description
+    {
+        public:
+            enum { BOX = 0, CAPPED_CYL, SPHERE };
+            enum { SERVO = 0, AX12, MX28, MX64, MX106 };
+            typedef std::map<std::string, double> params_t;
+
+            struct body_t
+            {
+                std::string name;
+                int type;
+                double mass;
+                /// box: l, w, h; capped_cyl: radius, length; sphere: radius
+                Eigen::Vector3d size;
+                Eigen::Vector3d pos;
+                bool rotated;
+                /// euler angles
+                Eigen::Vector3d rot;
+            };
+            struct axis_t
+            {
+                int index;
+                Eigen::Vector3d dir;
+            };
+            struct servo_t
+            {
+                int type;
+                size_t o1, o2;
+                Eigen::Vector3d anchor;
+                std::vector<axis_t> axes;
+            };
+
+            Description() : _main_body(0) {}
+            /// throws std::runtime_error (with the line) on errors
+            Description(const std::string& fname,
+                        const params_t& overrides = params_t());
+            void parse(std::istream& is, const params_t& overrides = params_t(),
+                       const std::string& fname = "<stream>");
+
+            const std::vector<body_t>& bodies() const { return _bodies; }
+            const std::vector<servo_t>& servos() const { return _servos; }
+            size_t main_body() const { return _main_body; }
+            const params_t& params() const { return _params; }
+            /// index of a body in bodies()
+            size_t body_index(const std::string& name) const;
+        protected:
+            std::vector<body_t> _bodies;
+            std::vector<servo_t> _servos;
+            size_t _main_body;
+            params_t _params;
+    };
+}
+
+#endif
@@ -0,0 +1,70 @@
+
+#include "generic.hh"
+#include "ode/box.hh"
+#include "ode/capped_cyl.hh"
+#include "ode/sphere.hh"
+#include "ode/ax12.hh"
+#include "ode/mx28.hh"
+
+using namespace ode;
+using namespace Eigen;
+
+namespace robot
+{
+    void Generic :: _build(const Description& desc, Environment& env, const Vector3d& pos)
+    {
+        BOOST_FOREACH(const Description::body_t& b, desc.bodies())
+        {
+            Object::ptr_t o;
+            switch (b.type)
+            {
+            case Description::BOX:
+                o = Object::ptr_t(new Box(env, pos + b.pos, b.mass, b.size[0], b.size[1], b.size[2]));
+                break;
+            case Description::CAPPED_CYL:
+                o = Object::ptr_t(new CappedCyl(env, pos + b.pos, b.mass, b.size[0], b.size[1]));
+                break;
+            case Description::SPHERE:
+                o = Object::ptr_t(new Sphere(env, pos + b.pos, b.mass, b.size[0]));
+                break;
+            default:
+                assert(0);
+            }
+            if (b.rotated)
+                o->set_rotation(b.rot[0], b.rot[1], b.rot[2]);
+            _bodies.push_back(o);
+        }
+        _main_body = _bodies[desc.main_body()];
+
+        BOOST_FOREACH(const Description::servo_t& s, desc.servos())
+        {
+            Object& o1 = *_bodies[s.o1];
+            Object& o2 = *_bodies[s.o2];
+            Vector3d anchor = pos + s.anchor;
+            Servo::ptr_t servo;
+            switch (s.type)
+            {
+            case Description::SERVO:
+                servo = Servo::ptr_t(new Servo(env, anchor, o1, o2));
+                break;
+            case Description::AX12:
+                servo = Servo::ptr_t(new Ax12(env, anchor, o1, o2));
+                break;
+            case Description::MX28:
+                servo = Servo::ptr_t(new Mx28(env, anchor, o1, o2));
+                break;
+            case Description::MX64:
+                servo = Servo::ptr_t(new Mx64(env, anchor, o1, o2));
+                break;
+            case Description::MX106:
+                servo = Servo::ptr_t(new Mx106(env, anchor, o1, o2));
+                break;
+            default:
+                assert(0);
+            }
+            BOOST_FOREACH(const Description::axis_t& a, s.axes)
+                servo->set_axis(a.index, a.dir);
+            _servos.push_back(servo);
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef ROBOT_GENERIC_HPP
+#define ROBOT_GENERIC_HPP
+#include "robot/robot.hh"
+#include "robot/description.hh"
+
+namespace robot
+{
+  /// a robot built from a declarative description (see description.hh),
+  /// e.g.:
+  ///   Description desc("data/robot4.rob");  // parsed once
+  ///   Generic rob(desc, env, pos);         // for each environment
+  class Generic : public Robot
+  {
+  public:
+    Generic(const Description& desc, ode::Environment& env, const Eigen::Vector3d& pos)
+    { _build(desc, env, pos); }
+  protected:
+    void _build(const Description& desc, ode::Environment& env, const Eigen::Vector3d& pos);
+  };
+}
+
+#endif
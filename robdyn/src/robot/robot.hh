@@ -52,17 +52,32 @@ namespace robot
             Eigen::Vector3d pos() const { return _main_body->get_pos(); }
             Eigen::Vector3d rot() const { return _main_body->get_rot(); }
             Eigen::Vector3d vel() const { return _main_body->get_vel(); }
+            // cheap orientation tests of the main body (see ode::Object)
+            Eigen::Vector3d up() const { return _main_body->get_up(); }
+            Eigen::Matrix3d rotation() const { return _main_body->get_rotation(); }
+            float tilt() const { return _main_body->get_tilt(); }
+            bool upside_down() const { return _main_body->upside_down(); }
             virtual void accept (ode::ConstVisitor &v) const { v.visit(_bodies); }
+            /// move every body by d (e.g. a clone in a slot of an
+            /// ode::BatchEnvironment); the joints follow since their
+            /// anchors and axes are stored relative to the bodies
+            void translate(const Eigen::Vector3d& d)
+            {
+                for (size_t i = 0; i < _bodies.size(); ++i)
+                    _bodies[i]->translate(d);
+            }
 
+            // called at every step: the pointers are not copied (no
+            // reference count updates)
             virtual void next_step(double dt = ode::Environment::time_step)
             {
-                BOOST_FOREACH(ode::Object::ptr_t s, _bodies)
-                    s->set_in_contact(false);
-                BOOST_FOREACH(ode::Servo::ptr_t s, _servos)
-                    s->next_step(dt);
-                BOOST_FOREACH(ode::Motor::ptr_t s, _motors)
-                    s->next_step(dt);
-           }
+                for (size_t i = 0; i < _bodies.size(); ++i)
+                    _bodies[i]->set_in_contact(false);
+                for (size_t i = 0; i < _servos.size(); ++i)
+                    _servos[i]->next_step(dt);
+                for (size_t i = 0; i < _motors.size(); ++i)
+                    _motors[i]->next_step(dt);
+            }
         protected:
             std::vector<ode::Object::ptr_t> _bodies;
             std::vector<ode::Servo::ptr_t> _servos;
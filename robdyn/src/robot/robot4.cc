@@ -37,15 +37,15 @@ namespace robot
         static const double lrear_length = 0.122; //lower rear leg
 
         //static const double ufront_stance_phi = -18*(M_PI/180); //rotation of upper front joint sweep
-        static double ufront_stance_phi = -18*(M_PI/180); //rotation of upper front joint sweep
-        static double ufront_stance_psi = -6*(M_PI/180); //rotation of upper front joint dihedral
-        static double lfront_stance_phi = (82-90-18)*(M_PI/180); //lower front
-        static double lfront_stance_psi = -16*(M_PI/180); //lower front
-
-        static double urear_stance_phi = -2*(M_PI/180); //rotation of upper rear joint sweep
-        static double urear_stance_psi = -15*(M_PI/180); //rotation of upper rear joint dihedral
-        static double lrear_stance_phi = (92-90-2)*(M_PI/180); //lower rear
-        static double lrear_stance_psi = -30*(M_PI/180); //lower rear
+        static const double ufront_stance_phi = -18*(M_PI/180); //rotation of upper front joint sweep
+        static const double ufront_stance_psi = -6*(M_PI/180); //rotation of upper front joint dihedral
+        static const double lfront_stance_phi = (82-90-18)*(M_PI/180); //lower front
+        static const double lfront_stance_psi = -16*(M_PI/180); //lower front
+
+        static const double urear_stance_phi = -2*(M_PI/180); //rotation of upper rear joint sweep
+        static const double urear_stance_psi = -15*(M_PI/180); //rotation of upper rear joint dihedral
+        static const double lrear_stance_phi = (92-90-2)*(M_PI/180); //lower rear
+        static const double lrear_stance_psi = -30*(M_PI/180); //lower rear
 
         static const double tfront_length = ufront_length + lfront_length;
         static const double trear_length = urear_length + lrear_length;
@@ -0,0 +1,111 @@
+/* Contact budget benchmark: the same random gaits are simulated with
+ * several contact caps (ode::Environment::set_max_contacts) and merging
+ * distances, on the gatest terrain. For each budget, it prints the time
+ * per physics step and how far the fitness moves from the default budget
+ * (10 contacts for every pair, no merging).
+ *
+ *   ./contact_bench [nb_gaits] [seed]
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <boost/random.hpp>
+
+#include "simulation.hh"
+#include <robot/robot4.hh>
+#include <ode/threading.hh>
+
+struct budget_t {
+    const char* name;
+    int all;        // every pair
+    int capsule;    // leg (capsule) vs ground plane / block
+    float merge;    // merging distance in m (0: no merging)
+};
+
+// the first one is the reference
+static const budget_t budgets[] = {
+    {"10 (default)", 10, 10, 0.0f},
+    {"capsule 4", 10, 4, 0.0f},
+    {"capsule 2", 10, 2, 0.0f},
+    {"capsule 1", 10, 1, 0.0f},
+    {"capsule 4, merge 1cm", 10, 4, 0.01f},
+    {"all 4", 4, 4, 0.0f},
+    {"all 2", 2, 2, 0.0f},
+};
+static const size_t nb_budgets = sizeof(budgets) / sizeof(budget_t);
+
+static void set_budget(ode::Environment& env, const budget_t& b){
+    env.set_max_contacts(b.all);
+    env.set_max_contacts(dCapsuleClass, dPlaneClass, b.capsule);
+    env.set_max_contacts(dCapsuleClass, dBoxClass, b.capsule);
+    env.set_contact_merging(b.merge);
+}
+
+int main(int argc, char **argv){
+    size_t nb_gaits = argc > 1 ? atoi(argv[1]) : 20;
+    unsigned seed = argc > 2 ? atoi(argv[2]) : 42;
+    const float step = 0.006f;
+    const int duration = 6;
+
+    ode::init();
+    // the ODE objects must be destroyed before ode::close()
+    {
+        ode::Environment env(0.0f, 0.0f, 0.0f);
+        Simulation::robot_t orob(new robot::robot4(env, Eigen::Vector3d(0, 0, 0.2)));
+
+        boost::mt19937 rng(seed);
+        boost::uniform_real<float> dist(0.0f, 1.0f);
+        std::vector<std::vector<float> > gaits(nb_gaits, std::vector<float>(20));
+        for(size_t g = 0; g < nb_gaits; ++g){
+            for(size_t i = 0; i < gaits[g].size(); ++i){
+                gaits[g][i] = dist(rng);
+            }
+        }
+
+        std::vector<std::vector<float> > fit(nb_budgets, std::vector<float>(nb_gaits));
+        std::vector<double> time(nb_budgets, 0);
+        std::vector<size_t> steps(nb_budgets, 0);
+        for(size_t g = 0; g < nb_gaits; ++g){
+            for(size_t b = 0; b < nb_budgets; ++b){
+                // same blocks for every budget
+                Simulation sim(orob, 0.0f, 150, 15, true, seed + g + 1);
+                set_budget(sim.environment(), budgets[b]);
+                std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+                fit[b][g] = sim.run_conf(gaits[g], step, duration);
+                time[b] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                steps[b] += sim.descriptor().steps();
+            }
+        }
+
+        std::cout << nb_gaits << " gaits, " << duration << " s at " << step << " s per step" << std::endl;
+        std::cout << std::setw(24) << std::left << "contacts"
+                  << std::right << std::setw(10) << "us/step"
+                  << std::setw(10) << "speedup"
+                  << std::setw(14) << "mean |dfit|"
+                  << std::setw(14) << "max |dfit|"
+                  << std::setw(12) << "mean fit" << std::endl;
+        double ref = time[0] / steps[0];
+        for(size_t b = 0; b < nb_budgets; ++b){
+            double per_step = time[b] / steps[b];
+            double mean_d = 0, max_d = 0, mean_f = 0;
+            for(size_t g = 0; g < nb_gaits; ++g){
+                double d = std::fabs(fit[b][g] - fit[0][g]);
+                mean_d += d / nb_gaits;
+                max_d = std::max(max_d, d);
+                mean_f += fit[b][g] / nb_gaits;
+            }
+            std::cout << std::setw(24) << std::left << budgets[b].name
+                      << std::right << std::fixed
+                      << std::setw(10) << std::setprecision(1) << per_step * 1e6
+                      << std::setw(10) << std::setprecision(2) << ref / per_step
+                      << std::setw(14) << std::setprecision(4) << mean_d
+                      << std::setw(14) << max_d
+                      << std::setw(12) << mean_f << std::endl;
+        }
+    }
+    ode::close();
+    return 0;
+}
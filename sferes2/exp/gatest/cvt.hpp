@@ -0,0 +1,269 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+#ifndef CVT_HPP_
+#define CVT_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <sferes/parallel.hpp>
+
+namespace sferes {
+  namespace ea {
+    namespace cvt {
+      // centroids are stored as a flat array: centroid k is
+      // [k * dim, (k + 1) * dim)
+      typedef std::vector<float> centroids_t;
+
+      inline float sq_dist(const float* a, const float* b, size_t dim) {
+        float d = 0.0f;
+        for (size_t i = 0; i < dim; ++i)
+          d += (a[i] - b[i]) * (a[i] - b[i]);
+        return d;
+      }
+
+      // static k-d tree over a set of centroids, for nearest-centroid
+      // queries (points must outlive the tree). In high dimension (e.g.
+      // the 19-D descriptors of gatest_cvt) it prunes little and most
+      // queries are close to a linear scan.
+      class KdTree {
+      public:
+        KdTree(const centroids_t& points, size_t dim) :
+          _points(points), _dim(dim), _index(points.size() / dim) {
+          for (size_t i = 0; i < _index.size(); ++i)
+            _index[i] = i;
+          _nodes.reserve(_index.size());
+          _build(0, _index.size(), 0);
+        }
+
+        // index of the nearest centroid (squared euclidean distance)
+        size_t nearest(const float* p) const {
+          assert(!_nodes.empty());
+          size_t best = 0;
+          float best_d = std::numeric_limits<float>::max();
+          _nearest(0, p, best, best_d);
+          return best;
+        }
+      protected:
+        struct node_t {
+          size_t point;
+          size_t axis;
+          int left, right;
+        };
+        struct cmp_t {
+          cmp_t(const centroids_t& p, size_t dim, size_t axis) :
+            points(p), dim(dim), axis(axis) {}
+          bool operator()(size_t a, size_t b) const {
+            return points[a * dim + axis] < points[b * dim + axis];
+          }
+          const centroids_t& points;
+          size_t dim, axis;
+        };
+
+        int _build(size_t begin, size_t end, size_t depth) {
+          if (begin >= end)
+            return -1;
+          size_t axis = depth % _dim;
+          size_t mid = (begin + end) / 2;
+          std::nth_element(_index.begin() + begin, _index.begin() + mid,
+                           _index.begin() + end, cmp_t(_points, _dim, axis));
+          int n = _nodes.size();
+          node_t node = { _index[mid], axis, -1, -1 };
+          _nodes.push_back(node);
+          int left = _build(begin, mid, depth + 1);
+          int right = _build(mid + 1, end, depth + 1);
+          _nodes[n].left = left;
+          _nodes[n].right = right;
+          return n;
+        }
+
+        void _nearest(int n, const float* p, size_t& best, float& best_d) const {
+          if (n < 0)
+            return;
+          const node_t& node = _nodes[n];
+          const float* c = &_points[node.point * _dim];
+          float d = sq_dist(p, c, _dim);
+          if (d < best_d) {
+            best_d = d;
+            best = node.point;
+          }
+          float diff = p[node.axis] - c[node.axis];
+          int near = diff < 0 ? node.left : node.right;
+          int far = diff < 0 ? node.right : node.left;
+          _nearest(near, p, best, best_d);
+          if (diff * diff < best_d)
+            _nearest(far, p, best, best_d);
+        }
+
+        const centroids_t& _points;
+        size_t _dim;
+        std::vector<size_t> _index;
+        std::vector<node_t> _nodes;
+      };
+
+      // points drawn uniformly in [0, 1]^Dim
+      template<size_t Dim>
+      struct Uniform {
+        static const size_t dim = Dim;
+        template<typename G>
+        void operator()(G& gen, float* p) const {
+          boost::uniform_real<float> u(0.0f, 1.0f);
+          for (size_t i = 0; i < dim; ++i)
+            p[i] = u(gen);
+        }
+      };
+
+      // descriptors made of NbFree values in [0, 1] followed by NbHist
+      // histograms of NbBins bins that each sum to 1: only this subset of
+      // [0, 1]^dim can be reached, so the histograms are drawn uniformly on
+      // the simplex (flat Dirichlet distribution) instead of in the cube
+      template<size_t NbFree, size_t NbHist, size_t NbBins>
+      struct Histograms {
+        static const size_t dim = NbFree + NbHist * NbBins;
+        template<typename G>
+        void operator()(G& gen, float* p) const {
+          boost::uniform_real<float> u(0.0f, 1.0f);
+          for (size_t i = 0; i < NbFree; ++i)
+            p[i] = u(gen);
+          for (size_t h = 0; h < NbHist; ++h) {
+            float* b = p + NbFree + h * NbBins;
+            float sum = 0.0f;
+            for (size_t i = 0; i < NbBins; ++i) {
+              b[i] = -logf(1.0f - u(gen));
+              sum += b[i];
+            }
+            for (size_t i = 0; i < NbBins; ++i)
+              b[i] /= sum;
+          }
+        }
+      };
+
+      // Lloyd's algorithm on nb_samples points drawn by Space (fixed seed:
+      // every run computes the same centroids); the samples are assigned
+      // to their centroid in parallel
+      template<typename Space>
+      inline centroids_t compute_centroids(size_t nb_centroids, size_t nb_samples,
+                                           size_t nb_iterations,
+                                           const Space& space = Space()) {
+        assert(nb_samples >= nb_centroids);
+        const size_t dim = Space::dim;
+        boost::mt19937 gen(42);
+        centroids_t samples(nb_samples * dim);
+        for (size_t s = 0; s < nb_samples; ++s)
+          space(gen, &samples[s * dim]);
+        // initial centroids: the first samples
+        centroids_t centroids(samples.begin(), samples.begin() + nb_centroids * dim);
+
+        parallel::init();
+        std::vector<size_t> nearest(nb_samples);
+        std::vector<double> sums(centroids.size());
+        std::vector<size_t> counts(nb_centroids);
+        for (size_t it = 0; it < nb_iterations; ++it) {
+          KdTree tree(centroids, dim);
+          parallel::p_for(parallel::range_t(0, nb_samples),
+          [&](const parallel::range_t& r) {
+            for (size_t s = r.begin(); s != r.end(); ++s)
+              nearest[s] = tree.nearest(&samples[s * dim]);
+          });
+          std::fill(sums.begin(), sums.end(), 0.0);
+          std::fill(counts.begin(), counts.end(), 0);
+          for (size_t s = 0; s < nb_samples; ++s) {
+            size_t k = nearest[s];
+            for (size_t i = 0; i < dim; ++i)
+              sums[k * dim + i] += samples[s * dim + i];
+            ++counts[k];
+          }
+          // empty cells keep their centroid
+          for (size_t k = 0; k < nb_centroids; ++k)
+            if (counts[k])
+              for (size_t i = 0; i < dim; ++i)
+                centroids[k * dim + i] = sums[k * dim + i] / counts[k];
+        }
+        return centroids;
+      }
+
+      // centroids read from fname (one centroid per line) if it holds
+      // nb_centroids centroids of the right size; otherwise they are
+      // computed and, if fname is not empty, written to fname
+      template<typename Space>
+      inline centroids_t centroids(size_t nb_centroids, size_t nb_samples,
+                                   size_t nb_iterations, const std::string& fname) {
+        const size_t dim = Space::dim;
+        centroids_t c;
+        if (!fname.empty()) {
+          std::ifstream ifs(fname.c_str());
+          float v;
+          while (ifs >> v)
+            c.push_back(v);
+          if (c.size() == nb_centroids * dim) {
+            std::cout << "centroids read from " << fname << std::endl;
+            return c;
+          }
+          if (!c.empty())
+            std::cerr << "warning: ignoring " << fname << " (wrong size)" << std::endl;
+        }
+
+        std::cout << "computing " << nb_centroids << " centroids ("
+                  << nb_samples << " samples, " << nb_iterations
+                  << " iterations)..." << std::endl;
+        c = compute_centroids<Space>(nb_centroids, nb_samples, nb_iterations);
+        if (fname.empty())
+          return c;
+        std::ofstream ofs(fname.c_str());
+        // enough digits to read back exactly the same centroids
+        ofs.precision(std::numeric_limits<float>::digits10 + 3);
+        for (size_t k = 0; k < nb_centroids; ++k) {
+          for (size_t i = 0; i < dim; ++i)
+            ofs << c[k * dim + i] << " ";
+          ofs << std::endl;
+        }
+        std::cout << "centroids written to " << fname << std::endl;
+        return c;
+      }
+    }
+  }
+}
+
+#endif
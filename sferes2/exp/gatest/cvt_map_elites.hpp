@@ -0,0 +1,116 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+#ifndef CVT_MAP_ELITES_HPP_
+#define CVT_MAP_ELITES_HPP_
+
+#include "map_elites.hpp"
+#include "cvt.hpp"
+
+namespace sferes {
+  namespace ea {
+    namespace cvt {
+      template<typename T>
+      struct void_ {
+        typedef void type;
+      };
+      // Params::ea::cvt_space_t if it is defined, Uniform<behav_dim> otherwise
+      template<typename P, typename = void>
+      struct space {
+        typedef Uniform<P::ea::behav_dim> type;
+      };
+      template<typename P>
+      struct space<P, typename void_<typename P::ea::cvt_space_t>::type> {
+        typedef typename P::ea::cvt_space_t type;
+      };
+      // Params::ea::cvt_file() if it is defined, no cache otherwise
+      template<typename P>
+      inline std::string file(int, typename void_<decltype(P::ea::cvt_file())>::type* = 0) {
+        return P::ea::cvt_file();
+      }
+      template<typename P>
+      inline std::string file(long) {
+        return "";
+      }
+    }
+
+    // CVT-MAP-Elites: Params::ea::nb_niches cells given by a centroidal
+    // Voronoi tessellation of the descriptor space (Vassiliades et al.,
+    // 2017). The number of cells does not grow with behav_dim, which
+    // makes large descriptors usable. The centroids are computed from
+    // Params::ea::nb_cvt_samples points drawn by Params::ea::cvt_space_t
+    // (default: uniform in [0, 1]^behav_dim); they are read from / written
+    // to Params::ea::cvt_file() if it is defined and not empty.
+    SFERES_EA(CvtMapElites, MapElitesBase) {
+    public:
+      static const size_t behav_dim = Params::ea::behav_dim;
+      typedef boost::array<float, behav_dim> point_t;
+
+      typedef typename cvt::space<Params>::type space_t;
+      static_assert(space_t::dim == behav_dim, "the CVT space must have behav_dim dimensions");
+
+      CvtMapElites() :
+        _centroids(cvt::centroids<space_t>(Params::ea::nb_niches,
+                                           Params::ea::nb_cvt_samples,
+                                           Params::ea::nb_cvt_iterations,
+                                           cvt::file<Params>(0))),
+        _tree(_centroids, behav_dim) {
+        this->_resize(Params::ea::nb_niches);
+      }
+
+      size_t cell_index(const point_t& p) const {
+        return _tree.nearest(p.data());
+      }
+
+      std::vector<float> cell_center(size_t k) const {
+        return std::vector<float>(_centroids.begin() + k * behav_dim,
+                                  _centroids.begin() + (k + 1) * behav_dim);
+      }
+
+      float dist_center(const point_t& p) const {
+        const float* c = &_centroids[cell_index(p) * behav_dim];
+        return sqrtf(cvt::sq_dist(p.data(), c, behav_dim));
+      }
+
+      const cvt::centroids_t& centroids() const {
+        return _centroids;
+      }
+    protected:
+      cvt::centroids_t _centroids;
+      cvt::KdTree _tree;
+    };
+  }
+}
+#endif
@@ -0,0 +1,183 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+#ifndef EMITTERS_HPP_
+#define EMITTERS_HPP_
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <sferes/stc.hpp>
+#include <sferes/misc.hpp>
+#include <sferes/ea/cmaes_interface.h>
+
+namespace sferes {
+  namespace ea {
+    namespace emitter {
+      // outcome of the insertion of an offspring in the archive
+      struct outcome_t {
+        outcome_t() : added(false), new_cell(false), delta(0.0f) {}
+        bool added;
+        bool new_cell;
+        // improvement over the previous elite (fitness if the cell was empty)
+        float delta;
+      };
+
+      // recent archive-improvement rate of an emitter
+      // (exponential moving average of the fraction of offspring added)
+      class Rate {
+       public:
+        SFERES_CONST float alpha = 0.1f;
+        Rate() : _value(1.0f) {} // optimistic: every emitter is tried first
+        void update(size_t nb_added, size_t nb_offspring) {
+          if (nb_offspring == 0)
+            return;
+          _value = (1.0f - alpha) * _value + alpha * nb_added / (float) nb_offspring;
+        }
+        float value() const {
+          return _value;
+        }
+       protected:
+        float _value;
+      };
+
+      // CMA-ME improvement emitter: a CMA-ES instance that ranks its
+      // offspring by archive improvement (new cells first, then by fitness
+      // gain) instead of by fitness, and restarts from a random elite when
+      // none of its offspring entered the archive.
+      // REFERENCE:
+      // Fontaine, M. C., Togelius, J., Nikolaidis, S. and Hoover, A. K.
+      // (2020). Covariance Matrix Adaptation for the Rapid Illumination of
+      // Behavior Space. GECCO 2020, pp. 94-102.
+      template<typename Phen>
+      class Improvement : boost::noncopyable {
+       public:
+        typedef boost::shared_ptr<Phen> indiv_t;
+        SFERES_CONST size_t dim = Phen::gen_t::gen_size;
+
+        Improvement() : _lambda(0) {
+          // cmaes_init() expects a zeroed structure
+          memset(&_evo, 0, sizeof(cmaes_t));
+        }
+        ~Improvement() {
+          if (_lambda)
+            cmaes_exit(&_evo);
+        }
+        // (re)start the search around an elite of the archive
+        void reset(const indiv_t& origin, float sigma) {
+          std::vector<double> xstart(dim), stddev(dim, sigma);
+          for (size_t j = 0; j < dim; ++j)
+            xstart[j] = origin->gen().data(j);
+          if (_lambda)
+            cmaes_exit(&_evo);
+          // "non": do not read or write any parameter file
+          cmaes_init(&_evo, dim, &xstart[0], &stddev[0],
+                     misc::rand<long>(1, 1L << 30), 0, "non");
+          _lambda = (size_t) cmaes_Get(&_evo, "lambda");
+          _origin = origin;
+        }
+        bool started() const {
+          return _lambda != 0;
+        }
+        size_t lambda() const {
+          return _lambda;
+        }
+        const indiv_t& origin() const {
+          return _origin;
+        }
+        const Rate& rate() const {
+          return _rate;
+        }
+        // append lambda new individuals to pop
+        void ask(std::vector<indiv_t>& pop) {
+          assert(started());
+          double* const* x = cmaes_SamplePopulation(&_evo);
+          for (size_t i = 0; i < _lambda; ++i) {
+            indiv_t indiv(new Phen());
+            for (size_t j = 0; j < dim; ++j)
+              indiv->gen().data(j, std::max(0.0, std::min(1.0, x[i][j])));
+            indiv->develop();
+            pop.push_back(indiv);
+          }
+        }
+        // outcomes of the last lambda individuals given by ask()
+        // returns false if the emitter must be restarted
+        bool tell(const outcome_t* outcomes) {
+          assert(started());
+          std::vector<size_t> order(_lambda);
+          for (size_t i = 0; i < _lambda; ++i)
+            order[i] = i;
+          std::sort(order.begin(), order.end(), _compare(outcomes));
+          // CMA-ES only uses the ranking (and minimizes)
+          std::vector<double> funvals(_lambda);
+          size_t nb_added = 0;
+          for (size_t r = 0; r < _lambda; ++r) {
+            funvals[order[r]] = r;
+            if (outcomes[order[r]].added)
+              ++nb_added;
+          }
+          _rate.update(nb_added, _lambda);
+          cmaes_UpdateDistribution(&_evo, &funvals[0]);
+          return nb_added > 0 && !cmaes_TestForTermination(&_evo);
+        }
+       protected:
+        cmaes_t _evo;
+        size_t _lambda;
+        indiv_t _origin;
+        Rate _rate;
+
+        struct _compare {
+          _compare(const outcome_t* o) : _o(o) {}
+          // new cells, then improved cells (largest gain first), then the rest
+          bool operator()(size_t i, size_t j) const {
+            int ci = _class(_o[i]), cj = _class(_o[j]);
+            if (ci != cj)
+              return ci < cj;
+            return _o[i].delta > _o[j].delta;
+          }
+          static int _class(const outcome_t& o) {
+            return o.new_cell ? 0 : (o.added ? 1 : 2);
+          }
+          const outcome_t* _o;
+        };
+      };
+    }
+  }
+}
+#endif
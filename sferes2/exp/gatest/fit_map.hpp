@@ -32,21 +32,41 @@
 //| The fact that you are presently reading this means that you have
 //| had knowledge of the CeCILL license and that you accept its terms.
 
+#ifndef FIT_MAP_HPP_
+#define FIT_MAP_HPP_
+
 #include <sferes/fit/fitness.hpp>
 
 #define FIT_MAP(Name) SFERES_FITNESS(Name, sferes::fit::FitMap)
 
 namespace sferes {
     namespace fit {
+        // evaluation requested from a fitness (multi-fidelity MAP-Elites):
+        // full (the default) or a cheap screening used to decide whether
+        // an offspring deserves the full evaluation
+        namespace fidelity {
+            enum fidelity_t { full = 0, screen };
+        }
+
         SFERES_FITNESS(FitMap, sferes::fit::Fitness)
         {
         public:
-            FitMap() : _desc(Params::ea::behav_dim) {}
+            FitMap() : _desc(Params::ea::behav_dim), _fidelity(fidelity::full) {}
             const std::vector<float>& desc() const
             {
                 return _desc;
             }
-
+            // fidelity of the next evaluation; MapElites sets it on the
+            // fitness prototype, so only the offspring being screened see
+            // screen (it is not serialized: the elites are always full)
+            void set_fidelity(fidelity::fidelity_t f)
+            {
+                _fidelity = f;
+            }
+            fidelity::fidelity_t fidelity() const
+            {
+                return _fidelity;
+            }
             /*void set_desc(float x1, float x2)
       {
         assert(x1 >= 0);
@@ -69,6 +89,9 @@ namespace sferes {
 
         protected:
             std::vector<float> _desc;
+            fidelity::fidelity_t _fidelity;
         };
     }
 }
+
+#endif
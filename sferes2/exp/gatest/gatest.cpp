@@ -3,6 +3,8 @@
 #include <sferes/gen/evo_float.hpp>
 #include <sferes/ea/nsga2.hpp>
 #include <sferes/eval/eval.hpp>
+#include <sferes/eval/parallel_scenarios.hpp>
+#include <sferes/eval/parallel_batches.hpp>
 #include <sferes/stat/pareto_front.hpp>
 #include <sferes/stat/best_fit.hpp>
 #include <sferes/stat/mean_fit.hpp>
@@ -17,10 +19,18 @@
 #include <sferes/stat/stat.hpp>
 
 #include "simulation.hh"
+#include <robot/robot4.hh>
+#include <robot/generic.hh>
+#include <ode/threading.hh>
+#ifndef NO_PARALLEL
+#include <ode/tbb_observer.hh>
+#endif
 
 #include "map_elites.hpp"
+#include "cvt_map_elites.hpp"
 #include "fit_map.hpp"
 #include "stat_map.hpp"
+#include "telemetry.hpp"
 #include <sferes/gen/sampled.hpp>
 
 //#include "stat_progress_archive.hpp"
@@ -28,14 +38,51 @@
 using namespace sferes;
 using namespace sferes::gen::evo_float;
 
-boost::shared_ptr<robot::robot4> orob;
+// uncomment to simulate several individuals in the same world
+// (eval::ParallelBatches + BatchSimulation)
+//#define BATCH_EVAL
+
+robot::Robot::ptr_t orob;
 boost::shared_ptr<ode::Environment> oenv;
+// --centroids (CVT variant)
+std::string centroids_file;
 
 struct Params {
     struct ea {
-        SFERES_CONST size_t behav_dim = 2;
+        // grid: duty factor of each leg; CVT: duty factors and body
+        // roll/pitch/yaw histograms (see Descriptor in simulation.hh)
+#ifdef CVT
+        SFERES_CONST size_t behav_dim = Descriptor::size;
+#else
+        SFERES_CONST size_t behav_dim = Descriptor::nb_legs;
+#endif
         SFERES_CONST double epsilon = 0;//0.05;
-        SFERES_ARRAY(size_t, behav_shape, 128, 128);
+        // QD-score offset: the fitness (-x, in m) is negative for gaits
+        // that move backwards
+        SFERES_CONST float qd_offset = -2.0f;
+        // multi-fidelity evaluation: a short rollout without blocks
+        // first, the full rollouts only for the offspring whose
+        // extrapolated fitness is within screen_margin (m) of the elite of
+        // their cell (or that land in an empty cell)
+        SFERES_CONST bool multi_fidelity = false;
+        SFERES_CONST float screen_margin = 0.1f;
+        SFERES_ARRAY(size_t, behav_shape, 10, 10, 10, 10);
+        // CVT variant (gatest_cvt): number of cells, and samples and
+        // Lloyd iterations used to compute the centroids; the samples are
+        // drawn in the reachable descriptor space (the roll/pitch/yaw
+        // histograms sum to 1). --centroids FILE caches the centroids.
+        SFERES_CONST size_t nb_niches = 10000;
+        SFERES_CONST size_t nb_cvt_samples = 50000;
+        SFERES_CONST size_t nb_cvt_iterations = 10;
+        typedef sferes::ea::cvt::Histograms<Descriptor::nb_legs, 3, Descriptor::nb_bins> cvt_space_t;
+        static std::string cvt_file() { return centroids_file; }
+        // CMA-ME improvement emitters (0: random emitter only)
+        SFERES_CONST size_t nb_emitters = 4;
+        SFERES_CONST float emitter_sigma = 0.05f;
+        // island model (one MAP-Elites per MPI rank, run with mpirun):
+        // improved elites are exchanged every exchange_period generations
+        // (0: no exchange, the ranks are independent runs)
+        SFERES_CONST size_t exchange_period = 0;
     };
     struct pop {
         // number of initial random points
@@ -45,6 +92,28 @@ struct Params {
         SFERES_CONST size_t nb_gen = 100000;
         SFERES_CONST size_t dump_period = 100;
     };
+    // surrogate pre-screening of the random emitter's offspring: a GP per
+    // output (fitness, descriptor) over the genome ranks pool_factor times
+    // more candidates than evaluated (see Surrogate in surrogate.hpp)
+    struct surrogate {
+        SFERES_CONST bool enabled = false;
+        // sliding window of evaluated individuals (training is cubic)
+        SFERES_CONST size_t nb_samples = 500;
+        SFERES_CONST size_t min_samples = 100;
+        SFERES_CONST size_t pool_factor = 4;
+        // weight of the uncertainty in the score
+        SFERES_CONST float kappa = 1.0f;
+        SFERES_CONST double noise = 0.01;
+    };
+    // kernel of the surrogate (limbo parameters)
+    struct kf_maternfivehalfs {
+        BO_PARAM(double, sigma, 1.0);
+        BO_PARAM(double, l, 0.5);
+    };
+    struct eval {
+        // robots simulated side by side in one world (BATCH_EVAL)
+        SFERES_CONST size_t batch_size = 8;
+    };
     struct parameters {
         SFERES_CONST float min = 0.0f;
         SFERES_CONST float max = 1.0f;
@@ -59,58 +128,176 @@ struct Params {
     };
 };
 
+// the two robustness rollouts are independent scenarios, run in
+// parallel by eval::ParallelScenarios (or, with BATCH_EVAL, for a batch
+// of individuals at once by eval::ParallelBatches); the worst one gives
+// the fitness
 FIT_MAP(GaitOpt){
     public :
+        SFERES_CONST size_t nb_rollouts = 2;
+        // steps between two flip tests (30 ms at the smallest time step)
+        SFERES_CONST size_t check_period = 5;
+        // simulated time (s) of a rollout; the screening fidelity runs
+        // only the first scenario, without blocks, for screen_duration
+        // and extrapolates the distance to duration
+        SFERES_CONST float duration = 6.0f;
+        SFERES_CONST float screen_duration = 1.5f;
+
         GaitOpt()  {}
+        size_t nb_scenarios() const {
+            return _screening() ? 1 : nb_rollouts;
+        }
+        template<typename Indiv>
+            void eval_scenario(Indiv& ind, size_t s) {
+                stat::Telemetry::ScopedRollout timer;
+                Simulation sim(orob, 0.00f, _screening() ? 0 : 150, 15, true);
+                sim.set_termination(&Simulation::flipped, check_period);
+                float d = _screening() ? screen_duration : duration;
+                _results[s] = sim.run_ind(ind, _step(s), d) * (duration / d);
+                _descs[s] = _desc(sim.descriptor());
+            }
+        // a batch counts as one rollout for the telemetry
+        template<typename Phen>
+            static void eval_batch(std::vector<boost::shared_ptr<Phen> >& pop,
+                                   size_t begin, size_t end, size_t s) {
+                stat::Telemetry::ScopedRollout timer;
+                std::vector<std::vector<float> > data;
+                for(size_t i = begin; i < end; ++i){
+                    data.push_back(pop[i]->data());
+                }
+                bool screening = pop[begin]->fit()._screening();
+                BatchSimulation sim(orob, end - begin, 0.00f, screening ? 0 : 150, 15);
+                sim.set_termination(&Simulation::flipped, check_period);
+                float d = screening ? screen_duration : duration;
+                std::vector<float> results = sim.run(data, _step(s), d);
+                for(size_t i = begin; i < end; ++i){
+                    pop[i]->fit()._results[s] = results[i - begin] * (duration / d);
+                    pop[i]->fit()._descs[s] = _desc(sim.descriptor(i - begin));
+                }
+            }
+        void reduce() {
+            //Choose worst of the two
+            size_t n = nb_scenarios();
+            this->_value = *std::min_element(_results, _results + n);
+
+            //behaviour measured during both rollouts
+            std::vector<float> data = _descs[0];
+            for(size_t s = 1; s < n; ++s){
+                for(size_t i = 0; i < data.size(); ++i){
+                    data[i] += _descs[s][i];
+                }
+            }
+            for(size_t i = 0; i < data.size(); ++i){
+                data[i] /= n;
+            }
+
+            this->set_desc(data);
+            if (stat::Telemetry::enabled())
+                stat::Telemetry::instance().eval();
+        }
         template<typename Indiv>
             void eval(Indiv& ind) {
                 if (this->mode() == sferes::fit::mode::view){
-                    Simulation sim1(orob, 0.00f, 0, 0, false);
-                    float result = sim1.run_ind(ind, 0.006f, 6);
-                    Simulation sim2(orob, 0.00f, 0, 0, false);
-                    float result2 = sim2.run_ind(ind, 0.0065f, 6);
-                    std::cout << "Fitness: " << result << " " << result2 << std::endl;
+                    std::cout << "Fitness:";
+                    for(size_t s = 0; s < nb_rollouts; ++s){
+                        Simulation sim(orob, 0.00f, 0, 0, false);
+                        sim.set_termination(&Simulation::flipped, check_period);
+                        std::cout << " " << sim.run_ind(ind, _step(s), duration);
+                    }
+                    std::cout << std::endl;
                 }else{
-                    Simulation sim1(orob, 0.00f, 150, 15, true);
-                    float result1 = sim1.run_ind(ind, 0.006f, 6);
-                    Simulation sim2(orob, 0.00f, 150, 15, true);
-                    float result2 = sim2.run_ind(ind, 0.0065f, 6);
-
-                    //Choose worst of the two
-                    if(result1 < result2){
-                        this->_value = result1;
-                    }else{
-                        this->_value = result2;
+                    for(size_t s = 0; s < nb_scenarios(); ++s){
+                        eval_scenario(ind, s);
                     }
-
-                    std::vector<float> data;
-                    data.push_back((ind.gen().data(6)+ind.gen().data(12))/2);//amplitudes of joints that lift
-                    data.push_back((ind.gen().data(9)+ind.gen().data(15))/2);//amplitudes of joints that sweep
-                    //data.push_back(ind.gen().data(19));
-
-                    this->set_desc(data);
+                    reduce();
                 }
             }
 
         bool dead(){
             return false;
         }
+    protected:
+        float _results[nb_rollouts];
+
+        bool _screening() const {
+            return this->fidelity() == fit::fidelity::screen;
+        }
+        std::vector<float> _descs[nb_rollouts];
+
+        static float _step(size_t s){
+            static const float steps[nb_rollouts] = {0.006f, 0.0065f};
+            return steps[s];
+        }
+        static std::vector<float> _desc(const Descriptor& desc){
+#ifdef CVT
+            return desc.all();
+#else
+            return desc.duty_factors();
+#endif
+        }
 };
 
 int main(int argc, char **argv) {
     std::cout<<"running "<<argv[0]<<" ... try --help for options (verbose)"<<std::endl;
-    dInitODE2(0);
-    oenv = boost::shared_ptr<ode::Environment>(new ode::Environment(0.0f, 0.0f, 0.0f));
-    orob = boost::shared_ptr<robot::robot4>(new robot::robot4(*oenv, Eigen::Vector3d(0, 0, 0.2)));
     typedef gen::EvoFloat<20, Params> gen_t;
     typedef phen::Parameters<gen_t, GaitOpt<Params>, Params> phen_t;
-    typedef eval::Parallel<Params> eval_t;
+#ifdef BATCH_EVAL
+    typedef eval::ParallelBatches<Params> eval_t;
+#else
+    typedef eval::ParallelScenarios<Params> eval_t;
+#endif
     typedef boost::fusion::vector<stat::Map<phen_t, Params>, stat::BestFit<phen_t, Params> > stat_t;
     typedef modif::Dummy<> modifier_t;
+#ifdef CVT
+    typedef ea::CvtMapElites<phen_t, eval_t, stat_t, modifier_t, Params> ea_t;
+#else
     typedef ea::MapElites<phen_t, eval_t, stat_t, modifier_t, Params> ea_t;
-    ea_t ea;
+#endif
+
+    namespace po = boost::program_options;
+    po::options_description opts("gatest options");
+    opts.add_options()
+        ("robot", po::value<std::string>(),
+         "robot description file (robdyn/data/robot4.rob; default: built-in robot4); "
+         "the descriptors and the controller expect the body/servo order of robot4")
+        ("telemetry", po::value<std::string>(),
+         "rewrite this JSON file with live metrics (evals/s, threads, archive, rollout times)")
+        ("telemetry-period", po::value<int>()->default_value(2000),
+         "telemetry period (ms)")
+        ("centroids", po::value<std::string>(),
+         "CVT variant: read the centroids from this file, or compute and write them to it");
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(opts)
+              .allow_unregistered().run(), vm);
+    if (vm.count("centroids"))
+        centroids_file = vm["centroids"].as<std::string>();
 
-    run_ea(argc, argv, ea);
-    dCloseODE();
+    // ODE data of the main thread and of each evaluation thread
+    ode::init();
+#ifndef NO_PARALLEL
+    ode::ThreadObserver ode_observer;
+#endif
+    oenv = boost::shared_ptr<ode::Environment>(new ode::Environment(0.0f, 0.0f, 0.0f));
+    Eigen::Vector3d pos(0, 0, 0.2);
+    // the description is parsed once; each rollout clones orob
+    if (vm.count("robot"))
+        orob = robot::Robot::ptr_t(new robot::Generic(robot::Description(vm["robot"].as<std::string>()),
+                                                      *oenv, pos));
+    else
+        orob = robot::Robot::ptr_t(new robot::robot4(*oenv, pos));
+
+    // opt-in live metrics (see telemetry.hpp)
+    if (vm.count("telemetry"))
+        stat::Telemetry::instance().start(vm["telemetry"].as<std::string>(),
+                                          vm["telemetry-period"].as<int>());
+
+    // after the options: the CVT centroids depend on --centroids
+    ea_t ea;
+    run_ea(argc, argv, ea, opts);
+    stat::Telemetry::instance().stop();
+    // the ODE objects must be destroyed before dCloseODE()
+    orob.reset();
+    oenv.reset();
+    ode::close();
     return 0;
 }
@@ -0,0 +1,194 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+#ifndef ISLANDS_HPP_
+#define ISLANDS_HPP_
+
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/mpi.hpp>
+#include <boost/optional.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace sferes {
+  namespace ea {
+    // elite sent to the other islands; its evaluation goes with it, so it
+    // is not evaluated again (the descriptor is not part of the
+    // serialization of FitMap)
+    template<typename Phen>
+    struct Migrant {
+      typename Phen::gen_t gen;
+      typename Phen::fit_t fit;
+      std::vector<float> desc;
+      template<class Archive>
+      void serialize(Archive& ar, const unsigned int version) {
+        ar & gen;
+        ar & fit;
+        ar & desc;
+      }
+    };
+
+    // Island model of MAP-Elites over MPI: each rank runs its own
+    // MAP-Elites and, at each exchange(), sends the elites of the cells it
+    // improved since the previous exchange (a delta, not the archive) to
+    // every other rank, then merges the deltas it has received by cell
+    // fitness, as if the migrants were offspring. Sends and receives do
+    // not block, so a slow island never stops the others; finish() sends
+    // the last delta and waits for the deltas still on the way.
+    //
+    // Ea must provide:
+    // - const array_t& archive() const
+    // - std::vector<size_t> take_changes() (cells improved since the last call)
+    // - bool merge(indiv_t)
+    template<typename Phen>
+    class Islands {
+    public:
+      typedef boost::shared_ptr<Phen> indiv_t;
+      typedef std::vector<Migrant<Phen> > delta_t;
+      SFERES_CONST int tag = 1;
+
+      Islands() : _finished(false) {
+        static char* argv[] = {(char*)"sferes2", 0x0};
+        int argc = 1;
+        char** argv2 = argv;
+        _env = boost::shared_ptr<boost::mpi::environment>
+               (new boost::mpi::environment(argc, argv2, true));
+        _world = boost::shared_ptr<boost::mpi::communicator>(new boost::mpi::communicator());
+        _sent.resize(_world->size(), 0);
+        _received.resize(_world->size(), 0);
+      }
+      // an interrupted run still has to match the messages of the others
+      ~Islands() {
+        if (!_finished)
+          _sync((no_archive_t*) 0);
+        _world.reset();
+        _env.reset();
+      }
+      int rank() const {
+        return _world->rank();
+      }
+      int size() const {
+        return _world->size();
+      }
+
+      template<typename Ea>
+      void exchange(Ea& ea) {
+        delta_t delta;
+        BOOST_FOREACH(size_t k, ea.take_changes()) {
+          Migrant<Phen> m;
+          m.gen = ea.archive()[k]->gen();
+          m.fit = ea.archive()[k]->fit();
+          m.desc = m.fit.desc();
+          delta.push_back(m);
+        }
+        if (!delta.empty())
+          for (int p = 0; p < size(); ++p)
+            if (p != rank()) {
+              _requests.push_back(_world->isend(p, tag, delta));
+              ++_sent[p];
+            }
+        _test_requests();
+
+        while (boost::optional<boost::mpi::status> s = _world->iprobe(boost::mpi::any_source, tag))
+          _recv(s->source(), &ea);
+        // the migrants are not sent back
+        ea.take_changes();
+      }
+      template<typename Ea>
+      void finish(Ea& ea) {
+        exchange(ea);
+        _sync(&ea);
+        ea.take_changes();
+      }
+
+    protected:
+      // the deltas are received but dropped
+      struct no_archive_t {
+        bool merge(indiv_t) {
+          return false;
+        }
+      };
+      boost::shared_ptr<boost::mpi::environment> _env;
+      boost::shared_ptr<boost::mpi::communicator> _world;
+      std::vector<boost::mpi::request> _requests;
+      // number of deltas sent to / received from each rank
+      std::vector<size_t> _sent;
+      std::vector<size_t> _received;
+      bool _finished;
+
+      // the number of deltas sent is exchanged, so that each rank knows
+      // how many are still on the way (merged in ea, if any)
+      template<typename Ea>
+      void _sync(Ea* ea) {
+        std::vector<size_t> expected;
+        boost::mpi::all_to_all(*_world, _sent, expected);
+        for (int p = 0; p < size(); ++p)
+          while (_received[p] < expected[p])
+            _recv(p, ea);
+        boost::mpi::wait_all(_requests.begin(), _requests.end());
+        _requests.clear();
+        _finished = true;
+      }
+      template<typename Ea>
+      void _recv(int source, Ea* ea) {
+        delta_t delta;
+        _world->recv(source, tag, delta);
+        ++_received[source];
+        if (!ea)
+          return;
+        BOOST_FOREACH(const Migrant<Phen>& m, delta) {
+          indiv_t i(new Phen());
+          i->gen() = m.gen;
+          i->fit() = m.fit;
+          std::vector<float> desc = m.desc;
+          i->fit().set_desc(desc);
+          i->develop();
+          ea->merge(i);
+        }
+      }
+      // forgets the sends that are done
+      void _test_requests() {
+        std::vector<boost::mpi::request> pending;
+        BOOST_FOREACH(boost::mpi::request& r, _requests)
+          if (!r.test())
+            pending.push_back(r);
+        _requests.swap(pending);
+      }
+    };
+  }
+}
+#endif
@@ -0,0 +1,137 @@
+/* Regression check of the island model (Islands in islands.hpp): a toy
+ * MAP-Elites runs on every MPI rank and exchanges its elites every
+ * exchange_period generations. Once the run is finished (every delta
+ * sent has been merged), all the ranks must hold the same archive:
+ * same occupied cells, same fitness, same genotype. The exit status is
+ * 0 if they do, 1 otherwise.
+ *
+ *   mpirun -np 4 ./islands_check
+ */
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+#include <boost/mpi.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <sferes/phen/parameters.hpp>
+#include <sferes/gen/evo_float.hpp>
+#include <sferes/eval/eval.hpp>
+#include <sferes/stat/best_fit.hpp>
+#include <sferes/modif/dummy.hpp>
+
+#include "map_elites.hpp"
+#include "fit_map.hpp"
+
+using namespace sferes;
+using namespace sferes::gen::evo_float;
+
+struct Params {
+    struct ea {
+        SFERES_CONST size_t behav_dim = 2;
+        SFERES_CONST double epsilon = 0;
+        SFERES_CONST float qd_offset = -20.0f;
+        SFERES_CONST bool multi_fidelity = false;
+        SFERES_CONST float screen_margin = 0.1f;
+        SFERES_ARRAY(size_t, behav_shape, 32, 32);
+        SFERES_CONST size_t nb_emitters = 2;
+        SFERES_CONST float emitter_sigma = 0.05f;
+        SFERES_CONST size_t exchange_period = 5;
+    };
+    struct surrogate {
+        SFERES_CONST bool enabled = false;
+        SFERES_CONST size_t nb_samples = 500;
+        SFERES_CONST size_t min_samples = 100;
+        SFERES_CONST size_t pool_factor = 4;
+        SFERES_CONST float kappa = 1.0f;
+        SFERES_CONST double noise = 0.01;
+    };
+    struct kf_maternfivehalfs {
+        BO_PARAM(double, sigma, 1.0);
+        BO_PARAM(double, l, 0.5);
+    };
+    struct pop {
+        SFERES_CONST size_t init_size = 100;
+        SFERES_CONST size_t size = 50;
+        // not a multiple of exchange_period: the last generation exchanges
+        // through Islands::finish
+        SFERES_CONST size_t nb_gen = 43;
+        SFERES_CONST int dump_period = -1;
+    };
+    struct parameters {
+        SFERES_CONST float min = 0.0f;
+        SFERES_CONST float max = 1.0f;
+    };
+    struct evo_float {
+        SFERES_CONST float cross_rate = 0.25f;
+        SFERES_CONST float mutation_rate = 0.1f;
+        SFERES_CONST float eta_m = 15.0f;
+        SFERES_CONST float eta_c = 10.0f;
+        SFERES_CONST mutation_t mutation_type = polynomial;
+        SFERES_CONST cross_over_t cross_over_type = sbx;
+    };
+};
+
+// a sphere; the descriptor (mean and mean square of the first half of
+// the genome) only covers part of the grid
+FIT_MAP(Toy){
+    public:
+        template<typename Indiv>
+        void eval(Indiv& ind) {
+            float a = 0, b = 0, f = 0;
+            for (size_t i = 0; i < ind.size(); ++i) {
+                if (i < ind.size() / 2) {
+                    a += ind.data(i);
+                    b += ind.data(i) * ind.data(i);
+                }
+                f -= (ind.data(i) - 0.3f) * (ind.data(i) - 0.3f);
+            }
+            this->_value = f;
+            std::vector<float> d;
+            d.push_back(a / (ind.size() / 2));
+            d.push_back(b / (ind.size() / 2));
+            this->set_desc(d);
+        }
+        bool dead() { return false; }
+};
+
+int main(int argc, char **argv) {
+    typedef gen::EvoFloat<10, Params> gen_t;
+    typedef phen::Parameters<gen_t, Toy<Params>, Params> phen_t;
+    typedef eval::Eval<Params> eval_t;
+    typedef boost::fusion::vector<stat::BestFit<phen_t, Params> > stat_t;
+    typedef modif::Dummy<> modifier_t;
+    typedef ea::MapElites<phen_t, eval_t, stat_t, modifier_t, Params> ea_t;
+
+    // the ranks start from different populations
+    srand(time(0) + getpid());
+    ea_t ea;
+    ea.run();
+
+    // cell, fitness and genotype of every elite (the MPI environment is
+    // owned by the islands of the EA, so the check is done before ea is
+    // destroyed)
+    std::vector<float> archive;
+    for (size_t k = 0; k < ea.archive().size(); ++k)
+        if (ea.archive()[k]) {
+            archive.push_back(k);
+            archive.push_back(ea.archive()[k]->fit().value());
+            for (size_t i = 0; i < ea.archive()[k]->gen().size(); ++i)
+                archive.push_back(ea.archive()[k]->gen().data(i));
+        }
+    boost::mpi::communicator world;
+    std::vector<std::vector<float> > archives;
+    boost::mpi::all_gather(world, archive, archives);
+
+    int ok = 1;
+    for (size_t r = 1; r < archives.size(); ++r)
+        if (archives[r] != archives[0]) {
+            ok = 0;
+            if (world.rank() == 0)
+                std::cerr << "rank " << r << ": the archive differs from rank 0" << std::endl;
+        }
+    if (world.rank() == 0)
+        std::cout << world.size() << " ranks, " << ea.archive_stats().size
+                  << " elites: " << (ok ? "identical archives" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -36,22 +36,96 @@
 #define MAP_ELITE_HPP_
 
 #include <algorithm>
+#include <functional>
 #include <limits>
+#include <stdint.h>
 
 #include <boost/foreach.hpp>
-#include <boost/multi_array.hpp>
 #include <boost/array.hpp>
 #include <boost/fusion/algorithm/iteration/for_each.hpp>
 #include <boost/fusion/include/for_each.hpp>
 
 #include <sferes/stc.hpp>
 #include <sferes/ea/ea.hpp>
+#include <sferes/parallel.hpp>
 #include <sferes/fit/fitness.hpp>
 
+#include "emitters.hpp"
+#include "fit_map.hpp"
+#include "surrogate.hpp"
+#ifdef MPI_ENABLED
+#include "islands.hpp"
+#endif
+
 namespace sferes {
   namespace ea {
-    // Main class
-    SFERES_EA(MapElites, Ea) {
+    // statistics of a MAP-Elites archive, maintained incrementally each
+    // time an elite is added or replaced
+    struct archive_stats_t {
+      archive_stats_t() : nb_cells(0), size(0), sum_fit(0), sum_dist(0),
+        sum_qd(0), max_fit(-std::numeric_limits<float>::max()) {}
+      size_t nb_cells;
+      size_t size;
+      double sum_fit;
+      double sum_dist;
+      // sum of max(fit - Params::ea::qd_offset, 0) over the elites
+      double sum_qd;
+      float max_fit;
+
+      float mean() const {
+        return size ? sum_fit / size : 0.0f;
+      }
+      float mean_dist_center() const {
+        return size ? sum_dist / size : 0.0f;
+      }
+      // QD-score: sum of the fitness of the elites shifted by
+      // Params::ea::qd_offset (a lower bound of the fitness), so that
+      // every elite counts positively; elites below the offset count 0
+      float qd_score() const {
+        return sum_qd;
+      }
+      float coverage() const {
+        return nb_cells ? size / (float) nb_cells : 0.0f;
+      }
+    };
+
+    // lineage of an elite: its parent when the elite was produced (the
+    // parent itself is not kept alive)
+    template<size_t D>
+    struct Lineage {
+      Lineage() : parent_cell(0), parent_fit(0), gen(0) {}
+      uint32_t parent_cell;
+      float parent_fit;
+      boost::array<float, D> parent_desc;
+      // generation of the elite
+      uint32_t gen;
+    };
+
+    // Common part of the MAP-Elites variants
+    // The archive is a flat array of cells (one elite per cell); the way a
+    // descriptor is mapped to a cell is given by Exact:
+    // - size_t cell_index(const point_t&) const
+    // - std::vector<float> cell_center(size_t) const
+    // - float dist_center(const point_t&) const
+    // Offspring are produced by emitters: the random emitter (uniform
+    // selection + cross-over/mutation) and Params::ea::nb_emitters CMA-ME
+    // improvement emitters. The batch (2 * Params::pop::size) is split
+    // according to the recent archive-improvement rate of each emitter.
+    // With Params::ea::multi_fidelity, the offspring are first evaluated
+    // at the screening fidelity (see FitMap) and only those that could
+    // enter the archive (empty cell, or screened fitness within
+    // Params::ea::screen_margin of the elite) get the full evaluation;
+    // the others are discarded.
+    // With Params::surrogate::enabled, the random emitter draws
+    // Params::surrogate::pool_factor times more offspring than it needs and
+    // only the best ones according to a surrogate of the evaluation (see
+    // Surrogate, trained on every evaluated individual) are evaluated: the
+    // score is the expected gain of QD-score with an optimistic fitness
+    // (mean + Params::surrogate::kappa * standard deviation).
+    // With Params::ea::exchange_period > 0 (requires MPI), each MPI rank is
+    // an island that sends the elites it improved to the others every
+    // exchange_period generations and merges theirs (see Islands).
+    SFERES_EA(MapElitesBase, Ea) {
     public:
       typedef boost::shared_ptr<Phen> indiv_t;
       typedef typename std::vector<indiv_t> pop_t;
@@ -61,21 +135,27 @@ namespace sferes {
       static const size_t behav_dim = Params::ea::behav_dim;
 
       typedef boost::array<float, behav_dim> point_t;
-      typedef boost::multi_array<phen_ptr_t, behav_dim> array_t;
-      typedef boost::array<typename array_t::index, behav_dim> behav_index_t;
-      behav_index_t behav_shape;
+      typedef std::vector<phen_ptr_t> array_t;
+      typedef emitter::Improvement<Phen> improvement_t;
+      typedef Lineage<behav_dim> lineage_t;
+      // aligned with the archive (only meaningful for the occupied cells)
+      typedef std::vector<lineage_t> lineage_array_t;
 
-
-      MapElites() {
-        assert(behav_dim == Params::ea::behav_shape_size());
-        for(size_t i = 0; i < Params::ea::behav_shape_size(); ++i)
-        behav_shape[i] = Params::ea::behav_shape(i);
-        _array.resize(behav_shape);
-        _array_parents.resize(behav_shape);
+      MapElitesBase() {
+#ifndef MPI_ENABLED
+        static_assert(Params::ea::exchange_period == 0,
+                      "the island model (exchange_period > 0) requires MPI");
+#endif
+        for (size_t i = 0; i < Params::ea::nb_emitters; ++i)
+          _emitters.push_back(boost::shared_ptr<improvement_t>(new improvement_t()));
       }
 
       void random_pop() {
         parallel::init();
+#ifdef MPI_ENABLED
+        if (Params::ea::exchange_period)
+          _islands = boost::shared_ptr<Islands<Phen> >(new Islands<Phen>());
+#endif
         this->_pop.resize(Params::pop::init_size);
         BOOST_FOREACH(boost::shared_ptr<Phen>&indiv, this->_pop) {
           indiv = boost::shared_ptr<Phen>(new Phen());
@@ -84,110 +164,314 @@ namespace sferes {
         this->_eval_pop(this->_pop, 0, this->_pop.size());
         BOOST_FOREACH(boost::shared_ptr<Phen>&indiv, this->_pop)
         _add_to_archive(indiv, indiv);
+        _learn(this->_pop, std::vector<bool>(this->_pop.size(), true));
       }
 
       void epoch() {
         this->_pop.clear();
 
-        for(const phen_ptr_t* i = _array.data(); i < (_array.data() + _array.num_elements()); ++i)
-        if(*i)
-        this->_pop.push_back(*i);
+        BOOST_FOREACH(const phen_ptr_t& i, _array)
+        if(i)
+        this->_pop.push_back(i);
 
         pop_t ptmp, p_parents;
-        for (size_t i = 0; i < Params::pop::size; ++i) {
+        // improvement emitters selected for this batch
+        std::vector<size_t> active = _allocate(2 * Params::pop::size);
+        BOOST_FOREACH(size_t e, active) {
+          _emitters[e]->ask(ptmp);
+          p_parents.resize(ptmp.size(), _emitters[e]->origin());
+        }
+        // the random emitter takes what is left
+        size_t nb_improvement = ptmp.size();
+        size_t nb_random = 2 * Params::pop::size - nb_improvement;
+        bool pre_screen = Params::surrogate::enabled && _surrogate.ready();
+        size_t pool_size = pre_screen ? nb_random * Params::surrogate::pool_factor : nb_random;
+        pop_t pool, pool_parents;
+        while (pool.size() < pool_size) {
           indiv_t p1 = _selection(this->_pop);
           indiv_t p2 = _selection(this->_pop);
           boost::shared_ptr<Phen> i1, i2;
           p1->cross(p2, i1, i2);
           i1->mutate();
-          i2->mutate();
           i1->develop();
-          i2->develop();
-          ptmp.push_back(i1);
-          ptmp.push_back(i2);
-          p_parents.push_back(p1);
-          p_parents.push_back(p2);
+          pool.push_back(i1);
+          pool_parents.push_back(p1);
+          // nb_random can be odd (the CMA-ES batches have any size): the
+          // second child is only kept if the batch still has room
+          if (pool.size() < pool_size) {
+            i2->mutate();
+            i2->develop();
+            pool.push_back(i2);
+            pool_parents.push_back(p2);
+          }
         }
-        this->_eval_pop(ptmp, 0, ptmp.size());
+        if (pre_screen)
+          _pre_screen(pool, pool_parents, nb_random);
+        ptmp.insert(ptmp.end(), pool.begin(), pool.end());
+        p_parents.insert(p_parents.end(), pool_parents.begin(), pool_parents.end());
+        std::vector<bool> promoted(ptmp.size(), true);
+        if (Params::ea::multi_fidelity)
+          promoted = _screen(ptmp);
+        else
+          this->_eval_pop(ptmp, 0, ptmp.size());
 
         assert(ptmp.size() == p_parents.size());
+        assert(ptmp.size() == 2 * Params::pop::size);
+        std::vector<emitter::outcome_t> outcomes(ptmp.size());
         for (size_t i = 0; i < ptmp.size(); ++i)
-        _add_to_archive(ptmp[i], p_parents[i]);
-      }
-
-
-      long int getindex(const array_t & m, const phen_ptr_t* requestedElement, const unsigned short int direction) const {
-        int offset = requestedElement - m.origin();
-        return (offset / m.strides()[direction] % m.shape()[direction] +  m.index_bases()[direction]);
-      }
+        if (promoted[i])
+          outcomes[i] = _try_add_to_archive(ptmp[i], p_parents[i]);
+        _learn(ptmp, promoted);
 
-      behav_index_t getindexarray(const array_t & m, const phen_ptr_t* requestedElement ) const {
-        behav_index_t _index;
-        for (unsigned int dir = 0; dir < behav_dim; dir++ ) {
-          _index[dir] = getindex( m, requestedElement, dir );
+        size_t offset = 0;
+        BOOST_FOREACH(size_t e, active) {
+          if (!_emitters[e]->tell(&outcomes[offset]))
+          _emitters[e]->reset(_selection(this->_pop), Params::ea::emitter_sigma);
+          offset += _emitters[e]->lambda();
         }
-
-        return _index;
+        size_t nb_added = 0;
+        for (size_t i = nb_improvement; i < ptmp.size(); ++i)
+        nb_added += outcomes[i].added;
+        _random_rate.update(nb_added, ptmp.size() - nb_improvement);
+#ifdef MPI_ENABLED
+        if (_islands) {
+          if (this->_gen + 1 == Params::pop::nb_gen)
+            _islands->finish(*this);
+          else if ((this->_gen + 1) % Params::ea::exchange_period == 0)
+            _islands->exchange(*this);
+        }
+#endif
       }
 
       const array_t& archive() const {
         return _array;
       }
-      const array_t& parents() const {
-        return _array_parents;
+      const lineage_array_t& parents() const {
+        return _lineage;
+      }
+      const archive_stats_t& archive_stats() const {
+        return _stats;
+      }
+      // cells that got a new elite since the previous call
+      std::vector<size_t> take_changes() {
+        std::vector<size_t> changes;
+        changes.swap(_changes);
+        BOOST_FOREACH(size_t k, changes)
+        _changed[k] = false;
+        return changes;
+      }
+      // tries to add an individual evaluated elsewhere (e.g. another
+      // island), which is its own parent
+      bool merge(indiv_t i) {
+        return _add_to_archive(i, i);
+      }
+      // elites are never modified once in the archive, so dumps can be
+      // written in the background
+      bool async_write() const {
+        return true;
       }
 
       template<typename I>
       point_t get_point(const I& indiv) const {
         return _get_point(indiv);
       }
+      // recent archive-improvement rates (random emitter first)
+      std::vector<float> emitter_rates() const {
+        std::vector<float> r(1, _random_rate.value());
+        BOOST_FOREACH(const boost::shared_ptr<improvement_t>& e, _emitters)
+        r.push_back(e->rate().value());
+        return r;
+      }
 
     protected:
       array_t _array;
-      array_t _prev_array;
-      array_t _array_parents;
+      lineage_array_t _lineage;
+      // distance of each elite to the center of its cell
+      std::vector<float> _cell_dist;
+      // cells changed since the last take_changes()
+      std::vector<size_t> _changes;
+      std::vector<bool> _changed;
+      archive_stats_t _stats;
+      std::vector<boost::shared_ptr<improvement_t> > _emitters;
+      emitter::Rate _random_rate;
+      Surrogate<Params> _surrogate;
+#ifdef MPI_ENABLED
+      boost::shared_ptr<Islands<Phen> > _islands;
+#endif
+
+      // called by Exact's constructor once the number of cells is known
+      void _resize(size_t nb_cells) {
+        _array.resize(nb_cells);
+        _lineage.resize(nb_cells);
+        _cell_dist.resize(nb_cells);
+        _changed.resize(nb_cells, false);
+        _stats.nb_cells = nb_cells;
+      }
+
+      // screening evaluation of the batch, then full evaluation of the
+      // promising offspring (returns which ones got it)
+      std::vector<bool> _screen(pop_t& ptmp) {
+        this->_fit_proto.set_fidelity(fit::fidelity::screen);
+        this->_eval_pop(ptmp, 0, ptmp.size());
+        this->_fit_proto.set_fidelity(fit::fidelity::full);
+
+        std::vector<bool> promoted(ptmp.size(), false);
+        pop_t full;
+        for (size_t i = 0; i < ptmp.size(); ++i)
+          if (!ptmp[i]->fit().dead()) {
+            size_t k = stc::exact(this)->cell_index(_get_point(ptmp[i]));
+            promoted[i] = !_array[k]
+                          || ptmp[i]->fit().value() + Params::ea::screen_margin
+                          > _array[k]->fit().value();
+            if (promoted[i])
+              full.push_back(ptmp[i]);
+          }
+        if (!full.empty())
+          this->_eval_pop(full, 0, full.size());
+        return promoted;
+      }
+
+      // keeps the nb candidates of the pool with the best surrogate score
+      void _pre_screen(pop_t& pool, pop_t& parents, size_t nb) {
+        std::vector<std::pair<float, size_t> > scores(pool.size());
+        for (size_t i = 0; i < pool.size(); ++i) {
+          typename Surrogate<Params>::prediction_t p = _surrogate.predict(pool[i]->data());
+          point_t pt;
+          for (size_t d = 0; d < behav_dim; ++d)
+            pt[d] = p.desc[d];
+          size_t k = stc::exact(this)->cell_index(pt);
+          // expected gain of QD-score (see archive_stats_t::sum_qd)
+          float ucb = p.fit + Params::surrogate::kappa * p.sigma;
+          float gain = _array[k] ? _qd(ucb) - _qd(_array[k]->fit().value()) : _qd(ucb);
+          scores[i] = std::make_pair(gain, i);
+        }
+        nb = std::min(nb, pool.size());
+        std::partial_sort(scores.begin(), scores.begin() + nb, scores.end(),
+                          std::greater<std::pair<float, size_t> >());
+        pop_t kept(nb), kept_parents(nb);
+        for (size_t i = 0; i < nb; ++i) {
+          kept[i] = pool[scores[i].second];
+          kept_parents[i] = parents[scores[i].second];
+        }
+        pool.swap(kept);
+        parents.swap(kept_parents);
+      }
+
+      // adds the fully evaluated individuals to the surrogate and
+      // retrains it
+      void _learn(const pop_t& pop, const std::vector<bool>& evaluated) {
+        if (!Params::surrogate::enabled)
+          return;
+        for (size_t i = 0; i < pop.size(); ++i)
+          if (evaluated[i] && !pop[i]->fit().dead())
+            _surrogate.add(pop[i]->data(), pop[i]->fit().value(), pop[i]->fit().desc());
+        _surrogate.train();
+      }
 
       bool _add_to_archive(indiv_t i1, indiv_t parent) {
+        return _try_add_to_archive(i1, parent).added;
+      }
+
+      // choose the improvement emitters that produce offspring in this
+      // batch: each emitter gets a share of the batch proportional to its
+      // improvement rate and is stepped with probability share / lambda
+      std::vector<size_t> _allocate(size_t batch) {
+        static const float min_rate = 0.05f;
+        float total = std::max(_random_rate.value(), min_rate);
+        BOOST_FOREACH(const boost::shared_ptr<improvement_t>& e, _emitters)
+        total += std::max(e->rate().value(), min_rate);
+
+        std::vector<size_t> active;
+        size_t used = 0;
+        for (size_t e = 0; e < _emitters.size(); ++e) {
+          if (!_emitters[e]->started())
+          _emitters[e]->reset(_selection(this->_pop), Params::ea::emitter_sigma);
+          size_t lambda = _emitters[e]->lambda();
+          float share = batch * std::max(_emitters[e]->rate().value(), min_rate) / total;
+          if (used + lambda <= batch && misc::rand<float>() < share / lambda) {
+            active.push_back(e);
+            used += lambda;
+          }
+        }
+        return active;
+      }
+
+      emitter::outcome_t _try_add_to_archive(indiv_t i1, indiv_t parent) {
+        emitter::outcome_t outcome;
         if(i1->fit().dead())
-        return false;
+        return outcome;
 
         point_t p = _get_point(i1);
+        size_t k = stc::exact(this)->cell_index(p);
+        assert(k < _array.size());
 
-        behav_index_t behav_pos;
-        for(size_t i = 0; i < Params::ea::behav_shape_size(); ++i) {
-          behav_pos[i] = round(p[i] * behav_shape[i]);
-          behav_pos[i] = std::min(behav_pos[i], behav_shape[i] - 1);
-          assert(behav_pos[i] < behav_shape[i]);
+        float fit = i1->fit().value();
+        float dist = -1.0f;
+        bool added = !_array[k] || (fit - _array[k]->fit().value()) > Params::ea::epsilon;
+        if (!added && fabs(fit - _array[k]->fit().value()) <= Params::ea::epsilon) {
+          dist = stc::exact(this)->dist_center(p);
+          added = dist < _cell_dist[k];
         }
-
-        if (!_array(behav_pos)
-        || (i1->fit().value() - _array(behav_pos)->fit().value()) > Params::ea::epsilon
-        || (fabs(i1->fit().value() - _array(behav_pos)->fit().value()) <= Params::ea::epsilon
-        && _dist_center(i1) < _dist_center(_array(behav_pos))) ) {
-          _array(behav_pos) = i1;
-          _array_parents(behav_pos) = parent;
-          return true;
+        if (added) {
+          if (dist < 0)
+          dist = stc::exact(this)->dist_center(p);
+          outcome.added = true;
+          outcome.new_cell = !_array[k];
+          outcome.delta = outcome.new_cell ? fit : fit - _array[k]->fit().value();
+          _update_stats(k, fit, dist);
+          _array[k] = i1;
+          _lineage[k] = _make_lineage(parent);
+          _cell_dist[k] = dist;
+          if (!_changed[k]) {
+            _changed[k] = true;
+            _changes.push_back(k);
+          }
         }
-        return false;
+        return outcome;
       }
 
+      lineage_t _make_lineage(const indiv_t& parent) const {
+        lineage_t l;
+        l.parent_desc = _get_point(parent);
+        l.parent_cell = stc::exact(this)->cell_index(l.parent_desc);
+        l.parent_fit = parent->fit().value();
+        l.gen = this->_gen;
+        return l;
+      }
 
-      template<typename I>
-      float _dist_center(const I& indiv) {
-        /* Returns distance to center of behavior descriptor cell */
-        float dist = 0.0;
-        point_t p = _get_point(indiv);
-        for(size_t i = 0; i < Params::ea::behav_shape_size(); ++i)
-        dist += pow(p[i] - (float)round(p[i] * (float)(behav_shape[i] - 1))/(float)(behav_shape[i] - 1), 2);
+      // called before cell k receives a new elite
+      void _update_stats(size_t k, float fit, float dist) {
+        if (!_array[k]) {
+          ++_stats.size;
+          _stats.sum_fit += fit;
+          _stats.sum_qd += _qd(fit);
+          _stats.sum_dist += dist;
+          _stats.max_fit = std::max(_stats.max_fit, fit);
+          return;
+        }
+        float old = _array[k]->fit().value();
+        _stats.sum_fit += fit - old;
+        _stats.sum_qd += _qd(fit) - _qd(old);
+        _stats.sum_dist += dist - _cell_dist[k];
+        if (fit >= _stats.max_fit)
+          _stats.max_fit = fit;
+        else if (old == _stats.max_fit) {
+          // the best elite got worse (only possible with epsilon > 0)
+          _stats.max_fit = fit;
+          for (size_t i = 0; i < _array.size(); ++i)
+            if (_array[i] && i != k)
+              _stats.max_fit = std::max(_stats.max_fit, _array[i]->fit().value());
+        }
+      }
 
-        dist=sqrt(dist);
-        return dist;
+      static float _qd(float fit) {
+        return std::max(fit - (float) Params::ea::qd_offset, 0.0f);
       }
 
       template<typename I>
       point_t _get_point(const I& indiv) const {
         point_t p;
-        for(size_t i = 0; i < Params::ea::behav_shape_size(); ++i)
+        for(size_t i = 0; i < behav_dim; ++i)
         p[i] = std::min(1.0f, indiv->fit().desc()[i]);
 
         return p;
@@ -199,6 +483,64 @@ namespace sferes {
       }
 
     };
+
+    // MAP-Elites on a regular grid of Params::ea::behav_shape cells
+    // (cells are stored in row-major order)
+    SFERES_EA(MapElites, MapElitesBase) {
+    public:
+      static const size_t behav_dim = Params::ea::behav_dim;
+      typedef boost::array<float, behav_dim> point_t;
+      typedef boost::array<long, behav_dim> behav_index_t;
+      behav_index_t behav_shape;
+
+      MapElites() {
+        assert(behav_dim == Params::ea::behav_shape_size());
+        size_t nb_cells = 1;
+        for(size_t i = 0; i < Params::ea::behav_shape_size(); ++i) {
+          behav_shape[i] = Params::ea::behav_shape(i);
+          nb_cells *= behav_shape[i];
+        }
+        this->_resize(nb_cells);
+      }
+
+      size_t cell_index(const point_t& p) const {
+        size_t k = 0;
+        for(size_t i = 0; i < behav_dim; ++i) {
+          long pos = round(p[i] * behav_shape[i]);
+          pos = std::min(pos, behav_shape[i] - 1);
+          assert(pos < behav_shape[i]);
+          k = k * behav_shape[i] + pos;
+        }
+        return k;
+      }
+
+      behav_index_t getindexarray(size_t k) const {
+        behav_index_t index;
+        for (int dir = behav_dim - 1; dir >= 0; --dir) {
+          index[dir] = k % behav_shape[dir];
+          k /= behav_shape[dir];
+        }
+        return index;
+      }
+
+      std::vector<float> cell_center(size_t k) const {
+        behav_index_t index = getindexarray(k);
+        std::vector<float> c(behav_dim);
+        for(size_t i = 0; i < behav_dim; ++i)
+        c[i] = index[i] / (float) behav_shape[i];
+        return c;
+      }
+
+      /* Returns distance to center of behavior descriptor cell */
+      float dist_center(const point_t& p) const {
+        float dist = 0.0;
+        for(size_t i = 0; i < behav_dim; ++i)
+        dist += pow(p[i] - (float)round(p[i] * (float)(behav_shape[i] - 1))/(float)(behav_shape[i] - 1), 2);
+
+        dist=sqrt(dist);
+        return dist;
+      }
+    };
   }
 }
 #endif
@@ -0,0 +1,133 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+#ifndef PROGRESS_SINK_HPP_
+#define PROGRESS_SINK_HPP_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace sferes {
+  namespace stat {
+    // one line of progress_archive.dat
+    struct progress_t {
+      unsigned long gen;
+      unsigned long size;
+      float mean;
+      float max;
+      float mean_dist_center;
+      float qd_score;
+      float coverage;
+    };
+
+    // Appends progress records to a file; the file is written and flushed
+    // by a background thread every period_ms (and when the sink is
+    // destroyed), so push() only copies a record under a lock.
+    // Text format: one record per line, fields in the order of progress_t.
+    // Binary format: raw progress_t records.
+    class ProgressSink : boost::noncopyable {
+    public:
+      ProgressSink(const std::string& fname, bool binary, int period_ms = 1000) :
+        _ofs(fname.c_str(), binary ? std::ios::out | std::ios::binary : std::ios::out),
+        _binary(binary),
+        _period_ms(period_ms),
+        _stop(false),
+        _thread(&ProgressSink::_run, this) {
+      }
+      ~ProgressSink() {
+        {
+          boost::mutex::scoped_lock lock(_mutex);
+          _stop = true;
+        }
+        _cond.notify_one();
+        _thread.join();
+      }
+      void push(const progress_t& p) {
+        boost::mutex::scoped_lock lock(_mutex);
+        _pending.push_back(p);
+      }
+    protected:
+      std::ofstream _ofs;
+      bool _binary;
+      int _period_ms;
+      bool _stop;
+      boost::mutex _mutex;
+      boost::condition_variable _cond;
+      std::vector<progress_t> _pending;
+      // only touched by the background thread
+      std::vector<progress_t> _writing;
+      boost::thread _thread;
+
+      void _run() {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (true) {
+          if (!_stop)
+            _cond.timed_wait(lock, boost::posix_time::milliseconds(_period_ms));
+          bool stop = _stop;
+          _writing.swap(_pending);
+          lock.unlock();
+          _write();
+          lock.lock();
+          if (stop)
+            break;
+        }
+      }
+
+      void _write() {
+        if (_writing.empty())
+          return;
+        if (_binary)
+          _ofs.write((const char*) &_writing[0], _writing.size() * sizeof(progress_t));
+        else
+          for (size_t i = 0; i < _writing.size(); ++i) {
+            const progress_t& p = _writing[i];
+            _ofs << p.gen << " " << p.size << " " << p.mean << " " << p.max
+                 << " " << p.mean_dist_center << " " << p.qd_score
+                 << " " << p.coverage << "\n";
+          }
+        _ofs.flush();
+        _writing.clear();
+      }
+    };
+  }
+}
+
+#endif
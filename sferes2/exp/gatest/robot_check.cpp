@@ -0,0 +1,107 @@
+/* Regression check of the robot description of robot4
+ * (robdyn/data/robot4.rob): gatest --robot relies on it having the
+ * bodies and servos of robot4::_build in the same order (the feet of
+ * simulation.cpp are bodies 4, 6, 8 and 10, the controller drives the
+ * servos by index). Both robots are built and compared body by body and
+ * servo by servo; overrides of params are checked too. The exit status
+ * is 0 if the description matches, 1 otherwise.
+ *
+ *   ./robot_check [robdyn/data/robot4.rob]
+ */
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+#include <ode/environment.hh>
+#include <robot/robot4.hh>
+#include <robot/generic.hh>
+#include <robot/description.hh>
+
+namespace {
+    int nb_errors = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++nb_errors;
+        }
+    }
+
+    bool close(const Eigen::MatrixXd& a, const Eigen::MatrixXd& b) {
+        return (a - b).cwiseAbs().maxCoeff() < 1e-9;
+    }
+
+    // index of a body of rob, bodies().size() if not found
+    size_t index_of(const robot::Robot& rob, const ode::Object& o) {
+        size_t i = 0;
+        while (i < rob.bodies().size() && rob.bodies()[i].get() != &o)
+            ++i;
+        return i;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::string fname = argc > 1 ? argv[1] : "robdyn/data/robot4.rob";
+    // lower leg segments, see simulation.cpp
+    static const size_t feet[4] = {4, 6, 8, 10};
+
+    dInitODE();
+    robot::Description desc(fname);
+    const Eigen::Vector3d pos(0, 0, 0.5);
+    ode::Environment env_ref, env;
+    robot::robot4 ref(env_ref, pos);
+    robot::Generic rob(desc, env, pos);
+
+    check(rob.bodies().size() == ref.bodies().size(), "number of bodies");
+    check(rob.servos().size() == ref.servos().size(), "number of servos");
+    if (nb_errors)
+        return 1;
+
+    for (size_t i = 0; i < ref.bodies().size(); ++i) {
+        const ode::Object& a = *ref.bodies()[i];
+        const ode::Object& b = *rob.bodies()[i];
+        const std::string name = "body " + desc.bodies()[i].name;
+        check(std::abs(a.get_mass() - b.get_mass()) < 1e-6, name + ": mass");
+        check(close(a.get_pos(), b.get_pos()), name + ": position");
+        check(close(a.get_rotation(), b.get_rotation()), name + ": rotation");
+    }
+    for (size_t i = 0; i < ref.servos().size(); ++i) {
+        const ode::Servo& a = *ref.servos()[i];
+        const ode::Servo& b = *rob.servos()[i];
+        std::ostringstream name;
+        name << "servo " << i;
+        check(index_of(ref, a.get_o1()) == index_of(rob, b.get_o1())
+              && index_of(ref, a.get_o2()) == index_of(rob, b.get_o2()), name.str() + ": bodies");
+        check(close(a.get_anchor(), b.get_anchor()), name.str() + ": anchor");
+    }
+    // the feet end the legs: they are the second body of a servo and the
+    // first body of none
+    for (size_t l = 0; l < 4; ++l) {
+        bool o1 = false, o2 = false;
+        for (size_t i = 0; i < desc.servos().size(); ++i) {
+            o1 = o1 || desc.servos()[i].o1 == feet[l];
+            o2 = o2 || desc.servos()[i].o2 == feet[l];
+        }
+        check(desc.bodies()[feet[l]].type == robot::Description::CAPPED_CYL && o2 && !o1,
+              "body " + desc.bodies()[feet[l]].name + " is not a foot");
+    }
+
+    robot::Description::params_t overrides;
+    overrides["leg_mass"] = 0.2;
+    robot::Description heavy(fname, overrides);
+    check(heavy.bodies()[feet[0]].mass == 0.2, "override of leg_mass");
+    overrides["leg_mas"] = 0.2;
+    bool thrown = false;
+    try {
+        robot::Description misspelled(fname, overrides);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "override of an unknown param");
+
+    std::cout << ref.bodies().size() << " bodies, " << ref.servos().size() << " servos: "
+              << (nb_errors ? "FAILED" : "same as robot4") << std::endl;
+    return nb_errors ? 1 : 0;
+}
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <iostream>
 
 #include <boost/foreach.hpp>
@@ -8,8 +9,100 @@
 
 #include "simulation.hh"
 
+// lower leg segments of robot4, in the order of robot4::_build
+// (front right, rear right, front left, rear left)
+static const size_t feet[Descriptor::nb_legs] = {4, 6, 8, 10};
+static const float max_angle = M_PI / 4;
+
+// The roll/pitch/yaw histograms are filled from the rotation matrix R of
+// the main body, without computing the Euler angles at each step. With
+// the angles of ode::Object::get_rot() (roll = atan2(R21, R22),
+// pitch = asin(-R20), yaw = atan2(R10, R00)), an angle atan2(s, c) with
+// c > 0 is at least the bin edge e iff s >= tan(e) c, and the pitch is at
+// least e iff -R20 >= sin(e).
+struct RotEdges{
+    float tan_e[Descriptor::nb_bins - 1];
+    float sin_e[Descriptor::nb_bins - 1];
+    RotEdges(){
+        for(size_t j = 0; j < Descriptor::nb_bins - 1; ++j){
+            float e = -max_angle + (j + 1) * 2 * max_angle / Descriptor::nb_bins;
+            tan_e[j] = tan(e);
+            sin_e[j] = sin(e);
+        }
+    }
+};
+static const RotEdges rot_edges;
+
+// bin of atan2(s, c)
+static size_t atan2_bin(double s, double c){
+    // |angle| >= 90 degrees: one of the outer bins
+    if(c <= 0)
+        return s >= 0 ? Descriptor::nb_bins - 1 : 0;
+    size_t bin = 0;
+    while(bin < Descriptor::nb_bins - 1 && s >= rot_edges.tan_e[bin] * c)
+        ++bin;
+    return bin;
+}
+
+// bin of asin(x)
+static size_t asin_bin(double x){
+    size_t bin = 0;
+    while(bin < Descriptor::nb_bins - 1 && x >= rot_edges.sin_e[bin])
+        ++bin;
+    return bin;
+}
+
+Descriptor::Descriptor(){
+    reset();
+}
+
+void Descriptor::reset(){
+    _steps = 0;
+    std::fill(_contacts, _contacts + nb_legs, 0);
+    std::fill(&_rot_bins[0][0], &_rot_bins[0][0] + 3 * nb_bins, 0);
+}
+
+void Descriptor::update(const robot::Robot& rob){
+    ++_steps;
+    for(size_t l = 0; l < nb_legs; ++l){
+        _contacts[l] += rob.bodies()[feet[l]]->get_in_contact();
+    }
+    Eigen::Matrix3d r = rob.rotation();
+    ++_rot_bins[0][atan2_bin(r(2, 1), r(2, 2))];
+    ++_rot_bins[1][asin_bin(-r(2, 0))];
+    ++_rot_bins[2][atan2_bin(r(1, 0), r(0, 0))];
+}
+
+float Descriptor::duty_factor(size_t leg) const{
+    assert(leg < nb_legs);
+    return _steps ? _contacts[leg] / (float)_steps : 0.0f;
+}
+
+float Descriptor::rot_hist(size_t axis, size_t bin) const{
+    assert(axis < 3 && bin < nb_bins);
+    return _steps ? _rot_bins[axis][bin] / (float)_steps : 0.0f;
+}
+
+std::vector<float> Descriptor::duty_factors() const{
+    std::vector<float> d(nb_legs);
+    for(size_t l = 0; l < nb_legs; ++l){
+        d[l] = duty_factor(l);
+    }
+    return d;
+}
+
+std::vector<float> Descriptor::all() const{
+    std::vector<float> d = duty_factors();
+    for(size_t a = 0; a < 3; ++a){
+        for(size_t b = 0; b < nb_bins; ++b){
+            d.push_back(rot_hist(a, b));
+        }
+    }
+    return d;
+}
+
 Simulation::Simulation(const robot_t& orob, const float tilt, const int count,
-        const int size, const bool headless) : env(new ode::Environment(0.0f, tilt, 0.0f)){
+        const int size, const bool headless, const unsigned seed) : env(new ode::Environment(0.0f, tilt, 0.0f)){
     this->headless = headless;
     this->tilt = tilt;
 
@@ -20,21 +113,22 @@ Simulation::Simulation(const robot_t& orob, const float tilt, const int count,
         rob->accept(*v);
     }
     if(count > 0 && size > 0){
-        add_blocks(count, size);
+        add_blocks(count, size, seed);
     }
 }
 
 /* Uses a 2D gaussian to spread blocks on the surface
  * https://en.wikipedia.org/wiki/Gaussian_function#Two-dimensional_Gaussian_function
  */
-void Simulation::add_blocks(int count, int size){
+void Simulation::make_blocks(ode::Environment& env, float tilt, int count, int size,
+        unsigned seed, const Eigen::Vector3d& offset, std::vector<ode::Object::ptr_t>& boxes){
 
     float xc = -0.4; //skew gauss and location
     float yc = 0;
     float s = 0.5; //spread gauss and location
 
     typedef boost::mt19937 RNGType;
-    RNGType rng( time(0) );
+    RNGType rng( seed );
     /* s-1 is the location based on how spread it is, which wraps the gaussian bell over
      * the relevant parts making the gauss and the locations in the same range.
      * The reason we subtract 1 is to chop off the "skirts" of the gauss, prevent the creation
@@ -63,23 +157,29 @@ void Simulation::add_blocks(int count, int size){
          *follow the slope
          */
         ode::Object::ptr_t b
-            (new ode::Box(*env, Eigen::Vector3d(x, y, bsize/2 + (tan(tilt)*-x)),
+            (new ode::Box(env, Eigen::Vector3d(x, y, bsize/2 + (tan(tilt)*-x)) + offset,
                           10, bsize*4, bsize*4, bsize)); //multiply by 4 to stretch out
 
         b->set_rotation(0.0f, -tilt, 0.0f);
         boxes.push_back(b);
-        if(!headless){
+        b->fix();
+        env.add_to_ground(*b);
+    }
+}
+
+void Simulation::add_blocks(int count, int size, unsigned seed){
+    make_blocks(*env, tilt, count, size, seed ? seed : time(0), Eigen::Vector3d::Zero(), boxes);
+    if(!headless){
+        BOOST_FOREACH(ode::Object::ptr_t b, boxes){
             b->accept(*v);
         }
-        b->fix();
-        env->add_to_ground(*b);
     }
 }
 
-float Simulation::run_conf(std::vector<float> config, const float step, const int step_limit){
+float Simulation::run_conf(std::vector<float> config, const float step, const float step_limit){
 
-    Eigen::Vector3d rotation;
     bool flipped = false;
+    size_t steps = 0;
 
     while(x < step_limit && !flipped) {
         if(!headless){
@@ -88,14 +188,13 @@ float Simulation::run_conf(std::vector<float> config, const float step, const in
             }
         }
         procedure(config, step);
-        rotation = rob->rot();
-
-        //std::cout << "Rot: " << rotation(0) * (180/M_PI) << std::endl;
-        if(abs(rotation(0) * (180/M_PI)) > 90){
-            flipped = true;
-            break;
+        if(++steps % check_period == 0){
+            flipped = check(*rob);
         }
     }
+    if(!flipped){
+        flipped = check(*rob);
+    }
 
     Eigen::Vector3d pos = rob->pos();
 
@@ -115,8 +214,13 @@ void Simulation::procedure(std::vector<float> data, const float step){
     }
     rob->next_step(step);
     env->next_step(step);
+    desc.update(*rob);
+    set_angles(*rob, data, x);
+}
+
+void Simulation::set_angles(robot::Robot& rob, const std::vector<float>& data, const float x){
     int genptr = 0;
-    for (size_t i = 0; i < rob->servos().size() - 4; ++i){
+    for (size_t i = 0; i < rob.servos().size() - 4; ++i){
         double phase = 0;
         float a = data.at(genptr++) * 40.0f;
         float theta = data.at(genptr++) * 1.0f;
@@ -137,14 +241,71 @@ void Simulation::procedure(std::vector<float> data, const float step){
         //}
 
         if(i <= 1){ //body joints only
-            rob->servos()[i]->set_angle(ode::Servo::DIHEDRAL, phase * M_PI/180);
+            rob.servos()[i]->set_angle(ode::Servo::DIHEDRAL, phase * M_PI/180);
         }else if(i == 3 || i == 5){
             phase = phase * 1.8f; //amplify phase to prevent stunted mobility of robot4
-            rob->servos()[i]->set_angle(ode::Servo::DIHEDRAL, (phase - s) * M_PI/180);
-            rob->servos()[i+4]->set_angle(ode::Servo::DIHEDRAL, (phase + s) * M_PI/180); //and opposite for other side
+            rob.servos()[i]->set_angle(ode::Servo::DIHEDRAL, (phase - s) * M_PI/180);
+            rob.servos()[i+4]->set_angle(ode::Servo::DIHEDRAL, (phase + s) * M_PI/180); //and opposite for other side
         }else{
-            rob->servos()[i]->set_angle(ode::Servo::DIHEDRAL, phase * M_PI/180);
-            rob->servos()[i+4]->set_angle(ode::Servo::DIHEDRAL, phase * M_PI/180); //and opposite for other side
+            rob.servos()[i]->set_angle(ode::Servo::DIHEDRAL, phase * M_PI/180);
+            rob.servos()[i+4]->set_angle(ode::Servo::DIHEDRAL, phase * M_PI/180); //and opposite for other side
+        }
+    }
+}
+
+BatchSimulation::BatchSimulation(const robot_t& orob, const size_t nb, const float tilt,
+        const int count, const int size) :
+    env(new ode::BatchEnvironment(nb, spacing, 0.0f, tilt, 0.0f)), descs(nb){
+    // same terrain in every slot
+    unsigned seed = time(0);
+    for(size_t k = 0; k < nb; ++k){
+        robs.push_back(orob->clone(env->slot(k)));
+        robs.back()->translate(env->offset(k));
+        if(count > 0 && size > 0){
+            Simulation::make_blocks(env->slot(k), tilt, count, size, seed,
+                                    env->offset(k), boxes);
+        }
+    }
+}
+
+std::vector<float> BatchSimulation::run(const std::vector<std::vector<float> >& data,
+        const float step, const float step_limit){
+    assert(data.size() == robs.size());
+    std::vector<bool> flipped(robs.size(), false);
+    size_t steps = 0;
+
+    while(x < step_limit && env->nb_active() > 0) {
+        x += step;
+        ++steps;
+        for(size_t k = 0; k < robs.size(); ++k){
+            if(env->active(k)){
+                robs[k]->next_step(step);
+            }
+        }
+        env->next_step(step);
+        for(size_t k = 0; k < robs.size(); ++k){
+            if(!env->active(k)){
+                continue;
+            }
+            descs[k].update(*robs[k]);
+            Simulation::set_angles(*robs[k], data[k], x);
+            if(steps % check_period == 0 && check(*robs[k])){
+                flipped[k] = true;
+                env->disable_slot(k);
+            }
+        }
+    }
+    for(size_t k = 0; k < robs.size(); ++k){
+        if(!flipped[k]){
+            flipped[k] = check(*robs[k]);
+        }
+    }
+
+    std::vector<float> fit(robs.size(), 0.0f);
+    for(size_t k = 0; k < robs.size(); ++k){
+        if(!flipped[k]){
+            fit[k] = -robs[k]->pos()(0);
         }
     }
+    return fit;
 }
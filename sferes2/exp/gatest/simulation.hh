@@ -2,13 +2,44 @@
 #define SIMULATION_HPP
 
 #include <stdlib.h> //For EXIT_SUCCESS
+#include <boost/function.hpp>
 
 #include <ode/environment.hh>
-#include <robot/robot4.hh>
+#include <ode/batch_environment.hh>
+#include <robot/robot.hh>
 #include <ode/box.hh>
 #include <ode/object.hh>
 #include <renderer/osg_visitor.hh>
 
+/* Behaviour descriptors accumulated online during a rollout
+ * (fixed-size counters, nothing is allocated while stepping)
+ * - duty factor of each leg: fraction of the steps with the lower leg
+ *   segment touching the ground (or a block)
+ * - roll/pitch/yaw histograms of the main body: fraction of the steps
+ *   spent in each of nb_bins bins over [-max_angle, max_angle]
+ */
+class Descriptor{
+    public:
+        static const size_t nb_legs = 4;
+        static const size_t nb_bins = 5;
+        static const size_t size = nb_legs + 3 * nb_bins;
+
+        Descriptor();
+        void reset();
+        void update(const robot::Robot&);
+
+        size_t steps() const { return _steps; }
+        float duty_factor(size_t leg) const;
+        float rot_hist(size_t axis, size_t bin) const;
+        // values in [0, 1], ready for FitMap::set_desc
+        std::vector<float> duty_factors() const;
+        std::vector<float> all() const;
+    private:
+        size_t _steps;
+        size_t _contacts[nb_legs];
+        size_t _rot_bins[3][nb_bins];
+};
+
 class Simulation{
     private:
         std::unique_ptr<renderer::OsgVisitor> v;
@@ -19,17 +50,68 @@ class Simulation{
         bool headless;
         float tilt;
         float x = 0;
+        Descriptor desc;
+        boost::function<bool (const robot::Robot&)> check = &Simulation::flipped;
+        size_t check_period = 1;
     public:
-        typedef boost::shared_ptr<robot::robot4> robot_t;
+        typedef robot::Robot::ptr_t robot_t;
         typedef boost::shared_ptr<ode::Environment> env_t;
+        typedef boost::function<bool (const robot::Robot&)> check_t;
+
+        // default termination test: the main body is upside down
+        // (|roll| > 90 degrees), without computing the Euler angles
+        static bool flipped(const robot::Robot& rob){ return rob.upside_down(); }
 
-        Simulation(const robot_t&, float, int, int, bool);
-        void add_blocks(int, int);
+        // the blocks are placed with the given seed (0: the current time)
+        Simulation(const robot_t&, float, int, int, bool, unsigned = 0);
+        void add_blocks(int, int, unsigned = 0);
+        // e.g. to set the contact budget before running
+        ode::Environment& environment(){ return *env; }
         //template<typename Indiv, typename Robot, typename Environment>
         template<typename Indiv>
-            float run_ind(Indiv, float, int);
-        float run_conf(std::vector<float>, float, int);
+            float run_ind(Indiv, float, float);
+        float run_conf(std::vector<float>, float, float);
         void procedure(std::vector<float>, float);
+        const Descriptor& descriptor() const { return desc; }
+        // the rollout stops (with a fitness of 0) when check(robot) is
+        // true; it is tested every period steps and after the last step
+        void set_termination(const check_t& c, size_t period){ check = c; check_period = period; }
+        // gait controller (see the servo list below) at time x
+        static void set_angles(robot::Robot&, const std::vector<float>&, float);
+        // blocks of add_blocks, translated by offset
+        static void make_blocks(ode::Environment&, float, int, int, unsigned,
+                                const Eigen::Vector3d&, std::vector<ode::Object::ptr_t>&);
+};
+
+/* Headless rollouts of several controllers at once: each robot is a
+ * clone of the template robot in its own slot of an ode::BatchEnvironment
+ * (with its own copy of the blocks), so one world step advances all of
+ * them. A robot that flips gets a fitness of 0 and its slot is disabled;
+ * the rollout ends when the time is up or when every robot has flipped.
+ */
+class BatchSimulation{
+    private:
+        // declared first: the robots and blocks are destroyed before it
+        boost::shared_ptr<ode::BatchEnvironment> env;
+        std::vector<robot::Robot::ptr_t> robs;
+        std::vector<ode::Object::ptr_t> boxes;
+        std::vector<Descriptor> descs;
+        float x = 0;
+        Simulation::check_t check = &Simulation::flipped;
+        size_t check_period = 1;
+    public:
+        typedef robot::Robot::ptr_t robot_t;
+        // lateral distance between two slots (only for viewing: the slots
+        // do not collide with each other)
+        static constexpr float spacing = 2.0f;
+
+        BatchSimulation(const robot_t&, size_t, float, int, int);
+        size_t size() const { return robs.size(); }
+        // one controller per robot, one fitness per robot
+        std::vector<float> run(const std::vector<std::vector<float> >&, float, float);
+        const Descriptor& descriptor(size_t k) const { return descs[k]; }
+        // see Simulation::set_termination
+        void set_termination(const Simulation::check_t& c, size_t period){ check = c; check_period = period; }
 };
 
 /* Robot4 servos
@@ -48,36 +130,8 @@ class Simulation{
  * 9 - R L L DIHED
  */
 template<typename Indiv>
-float Simulation::run_ind(Indiv ind, const float step, const int step_limit){
-    std::vector<float> data = ind.data();
-
-    Eigen::Vector3d rotation;
-    bool flipped = false;
-
-    while(x < step_limit && !flipped) {
-        if(!headless){
-            if(v->done()){ //If user presses escape in window
-                exit(EXIT_SUCCESS); //abort everything including sferes-backend
-            }
-        }
-        procedure(data, step);
-        rotation = rob->rot();
-
-//        std::cout << "Rot: " << rotation(0) * (180/M_PI) << std::endl;
-        if(abs(rotation(0) * (180/M_PI)) > 90){
-            flipped = true;
-            break;
-        }
-    }
-
-    Eigen::Vector3d pos = rob->pos();
-
-    //std::cout << "Fitness: " << -pos(0) << std::endl;
-    if(!flipped){
-        return -pos(0);
-    }else{
-        return 0.0f;
-    }
+float Simulation::run_ind(Indiv ind, const float step, const float step_limit){
+    return run_conf(ind.data(), step, step_limit);
 }
 
 
@@ -2,65 +2,92 @@
 #define STAT_MAP_HPP_
 
 #include <numeric>
-#include <boost/multi_array.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/serialization/split_member.hpp>
 #include <sferes/stat/stat.hpp>
+#include <sferes/misc/async_writer.hpp>
+
+#include "progress_sink.hpp"
+#include "telemetry.hpp"
 
 #define MAP_WRITE_PARENTS
+// progress_archive.bin (raw stat::progress_t records) instead of
+// progress_archive.dat
+//#define MAP_PROGRESS_BINARY
 
 namespace sferes {
   namespace stat {
+    // works with any MAP-Elites variant (grid or CVT): cells are read
+    // through ea.archive() / ea.cell_center() / ea.dist_center()
+    // Progress is taken from ea.archive_stats() (maintained by the EA) and
+    // written by a background thread, so a generation without dump costs
+    // O(1) here; the archive itself is only read when it is written.
     SFERES_STAT(Map, Stat) {
     public:
       typedef boost::shared_ptr<Phen> phen_t;
-      typedef boost::multi_array<phen_t, Params::ea::behav_dim> array_t;
-      typedef boost::array<float, Params::ea::behav_dim> point_t;
-      typedef boost::array<typename array_t::index, Params::ea::behav_dim> behav_index_t;
+      typedef std::vector<phen_t> array_t;
 
       size_t behav_dim;
-      behav_index_t behav_shape;
-      behav_index_t behav_strides;
-      behav_index_t behav_indexbase;
 
-      Map() : behav_dim(Params::ea::behav_dim) {
-        for(size_t i = 0; i < Params::ea::behav_shape_size(); ++i)
-          behav_shape[i] = Params::ea::behav_shape(i);
+      Map() : behav_dim(Params::ea::behav_dim), _ea_archive(0) {
+      }
+      // snapshot (used by the background writer): owns a copy of the
+      // archive of the EA
+      Map(const Map& o) :
+        behav_dim(o.behav_dim),
+        _archive(o._ea_archive ? *o._ea_archive : o._archive),
+        _ea_archive(0) {
       }
 
       template<typename E>
       void refresh(const E& ea) {
-        _archive.clear();
-
-        for(size_t i = 0; i < behav_dim; ++i) {
-          assert(ea.archive().shape()[i] == behav_shape[i]);
-          behav_strides[i] = ea.archive().strides()[i];
-          behav_indexbase[i] = ea.archive().index_bases()[i];
+        _ea_archive = &ea.archive();
+
+        if (!_sink && ea.dump_enabled()) {
+#ifdef MAP_PROGRESS_BINARY
+          std::string fname = ea.res_dir() + "/progress_archive.bin";
+          bool binary = true;
+#else
+          std::string fname = ea.res_dir() + "/progress_archive.dat";
+          bool binary = false;
+#endif
+          _sink = boost::shared_ptr<ProgressSink>(new ProgressSink(fname, binary));
         }
-
-        for(const phen_t* i = ea.archive().data(); i < (ea.archive().data() + ea.archive().num_elements()); ++i) {
-          phen_t p = *i;
-          _archive.push_back(p);
+        if (_sink || Telemetry::enabled()) {
+          progress_t p = _progress(ea.gen(), ea.archive_stats());
+          if (_sink)
+            _sink->push(p);
+          if (Telemetry::enabled())
+            Telemetry::instance().progress(p);
         }
 
-        this->_create_log_file(ea, "progress_archive.dat");
-        _write_progress(ea, *this->_log_file);
-
-        if (ea.gen() % Params::pop::dump_period == 0) {
-          _write_archive(ea.archive(), std::string("archive_"), ea);
-#ifdef MAP_WRITE_PARENTS
-          _write_parents(ea.archive(), ea.parents(), std::string("parents_"), ea);
-#endif
+        // the text files are written in the background from copies of the
+        // archive and of the parents; the jobs do not refer to the EA, which
+        // may be destroyed before they are done
+        if (ea.dump_enabled() && ea.gen() % Params::pop::dump_period == 0) {
+          if (!_centers) {
+            // the cells do not move during a run
+            boost::shared_ptr<centers_t> c(new centers_t(ea.archive().size()));
+            for (size_t k = 0; k < c->size(); ++k)
+              (*c)[k] = ea.cell_center(k);
+            _centers = c;
+          }
+          boost::shared_ptr<const array_t> array(new array_t(ea.archive()));
+          typedef typename E::lineage_array_t lineage_array_t;
+          boost::shared_ptr<const lineage_array_t> parents(new lineage_array_t(ea.parents()));
+          misc::AsyncWriter::instance().push(boost::bind(&Map::template _dump<lineage_array_t>,
+                                             array, parents, _centers, ea.res_dir(), ea.gen()));
         }
       }
 
 
       void show(std::ostream& os, size_t k) {
-        std::cerr << "loading " ;
-        for(size_t i = 0; i < behav_dim; ++i)
-          std::cerr << (k / behav_strides[i] % behav_shape[i] +  behav_indexbase[i]) << ",";
-        std::cerr << std::endl;
-
-
+        if (k >= _archive.size()) {
+          std::cerr << "Warning, only " << _archive.size() << " cells" << std::endl;
+          return;
+        }
         if (_archive[k]) {
+          std::cerr << "loading cell " << k << std::endl;
           _archive[k]->develop();
           _archive[k]->show(os);
           _archive[k]->fit().set_mode(fit::mode::view);
@@ -69,123 +96,114 @@ namespace sferes {
           std::cerr << "Warning, no point here" << std::endl;
       }
 
+      // while running, the archive is saved directly from the EA
+      template<class Archive>
+      void save(Archive& ar, const unsigned int version) const {
+        const array_t& _archive = _ea_archive ? *_ea_archive : this->_archive;
+        ar & BOOST_SERIALIZATION_NVP(_archive);
+        ar & BOOST_SERIALIZATION_NVP(behav_dim);
+      }
       template<class Archive>
-      void serialize(Archive& ar, const unsigned int version) {
+      void load(Archive& ar, const unsigned int version) {
         ar & BOOST_SERIALIZATION_NVP(_archive);
         ar & BOOST_SERIALIZATION_NVP(behav_dim);
-        ar & BOOST_SERIALIZATION_NVP(behav_shape);
-        ar & BOOST_SERIALIZATION_NVP(behav_strides);
-        ar & BOOST_SERIALIZATION_NVP(behav_indexbase);
+        _ea_archive = 0;
       }
+      BOOST_SERIALIZATION_SPLIT_MEMBER();
 
 
 
     protected:
+      // filled when loading a generation file
       std::vector<phen_t> _archive;
-      //int _xs, _ys;
-
-      template<typename EA>
-      void _write_parents(const array_t& array,
-                          const array_t& p_array,
-                          const std::string& prefix,
-                          const EA& ea) const {
-        std::cout << "writing..." << prefix << ea.gen() << std::endl;
-        std::string fname =  ea.res_dir() + "/"
+      const array_t* _ea_archive;
+      boost::shared_ptr<ProgressSink> _sink;
+      // center of each cell of the EA (for the text files)
+      typedef std::vector<std::vector<float> > centers_t;
+      boost::shared_ptr<const centers_t> _centers;
+
+      // one line per elite: cell center, fitness of the parent, center of
+      // the cell of the parent, fitness
+      template<typename L>
+      static void _write_parents(const array_t& array,
+                                 const L& lineage,
+                                 const centers_t& centers,
+                                 const std::string& prefix,
+                                 const std::string& res_dir, size_t gen) {
+        std::cout << "writing..." << prefix << gen << std::endl;
+        std::string fname =  res_dir + "/"
                              + prefix
                              + boost::lexical_cast<
-                             std::string>(ea.gen())
+                             std::string>(gen)
                              + std::string(".dat");
         std::ofstream ofs(fname.c_str());
 
-        for(const phen_t* i = array.data(); i < (array.data() + array.num_elements()); ++i) {
-          if (*i) {
-            behav_index_t idx = ea.getindexarray(array, i);
-            assert(array(idx)->fit().value() == (*i)->fit().value());
-            if(p_array(idx)) {
-              for(size_t dim = 0; dim < behav_dim; ++dim)
-                ofs << idx[dim] / (float) behav_shape[dim] << " ";
-              ofs << " " << p_array(idx)->fit().value() << " " ;
-
-              point_t p = ea.get_point(p_array(idx));
-              behav_index_t posinparent;
-              for(size_t dim = 0; dim < behav_dim; ++dim) {
-                posinparent[dim] = round(p[dim] * behav_shape[dim]);
-                ofs << posinparent[dim] / (float) behav_shape[dim] << " ";
-              }
-              ofs << " " << array(idx)->fit().value() << std::endl;
-            }
+        for (size_t k = 0; k < array.size(); ++k) {
+          if (array[k]) {
+            const std::vector<float>& c = centers[k];
+            for(size_t dim = 0; dim < Params::ea::behav_dim; ++dim)
+              ofs << c[dim] << " ";
+            ofs << " " << lineage[k].parent_fit << " " ;
+
+            const std::vector<float>& cp = centers[lineage[k].parent_cell];
+            for(size_t dim = 0; dim < Params::ea::behav_dim; ++dim)
+              ofs << cp[dim] << " ";
+            ofs << " " << array[k]->fit().value() << std::endl;
           }
         }
       }
 
-      template<typename EA>
-      void _write_archive(const array_t& array,
-                          const std::string& prefix,
-                          const EA& ea) const {
-        std::cout << "writing..." << prefix << ea.gen() << std::endl;
-        std::string fname = ea.res_dir() + "/"
+      // one line per elite: cell index, cell center, fitness, genotype
+      static void _write_archive(const array_t& array,
+                                 const centers_t& centers,
+                                 const std::string& prefix,
+                                 const std::string& res_dir, size_t gen) {
+        std::cout << "writing..." << prefix << gen << std::endl;
+        std::string fname = res_dir + "/"
                             + prefix
                             + boost::lexical_cast<
-                            std::string>(ea.gen())
+                            std::string>(gen)
                             + std::string(".dat");
 
         std::ofstream ofs(fname.c_str());
 
-        size_t offset = 0;
-        for(const phen_t* i = array.data(); i < (array.data() + array.num_elements()); ++i) {
-          if (*i) {
-            behav_index_t posinarray = ea.getindexarray(array, i);
-            assert(array(posinarray)->fit().value() == (*i)->fit().value());
-
-            ofs << offset << "    ";
-            for(size_t dim = 0; dim < behav_dim; ++dim)
-              ofs << posinarray[dim] / (float) behav_shape[dim] << " ";
-            ofs << " " << array(posinarray)->fit().value() << " ";
-            for (size_t i = 0; i <= 19; i++) {
-                ofs << array(posinarray)->gen().data(i) << " ";
-            }
+        for (size_t k = 0; k < array.size(); ++k) {
+          if (array[k]) {
+            ofs << k << "    ";
+            const std::vector<float>& c = centers[k];
+            for(size_t dim = 0; dim < Params::ea::behav_dim; ++dim)
+              ofs << c[dim] << " ";
+            ofs << " " << array[k]->fit().value() << " ";
+            for (size_t i = 0; i < array[k]->gen().size(); i++)
+              ofs << array[k]->gen().data(i) << " ";
             ofs << std::endl;
           }
-          ++offset;
         }
 
       }
 
-      template<typename EA>
-      void _write_progress(const EA& ea, std::ofstream& ofs) const {
-
-        const array_t& array = ea.archive();
-
-        size_t archive_size = 0;
-        float archive_mean = 0.0f;
-        float archive_max = -1e10;
-        float mean_dist_center = 0.0f;
-
-        for(const phen_t* i = array.data(); i < (array.data() + array.num_elements()); ++i) {
-          if(*i) {
-            phen_t p = *i;
-            archive_size++;
-            archive_mean += p->fit().value();
-
-            if(archive_max < p->fit().value())
-              archive_max = p->fit().value();
-
-            float dist = 0.0f;
-            for(size_t i = 0; i < Params::ea::behav_shape_size(); ++i) {
-              assert(p->fit().desc()[i] >= 0.0f && p->fit().desc()[i] <= 1.0f);
-
-              float diff = p->fit().desc()[i] -
-                           (float)round(p->fit().desc()[i] * (float)(Params::ea::behav_shape(i)-1)) / (float)(Params::ea::behav_shape(i) - 1);
-
-              dist += diff * diff;
-            }
-            mean_dist_center+=sqrtf(dist);
-          }
-        }
+      template<typename L>
+      static void _dump(boost::shared_ptr<const array_t> array,
+                        boost::shared_ptr<const L> parents,
+                        boost::shared_ptr<const centers_t> centers,
+                        const std::string& res_dir, size_t gen) {
+        _write_archive(*array, *centers, std::string("archive_"), res_dir, gen);
+#ifdef MAP_WRITE_PARENTS
+        _write_parents(*array, *parents, *centers, std::string("parents_"), res_dir, gen);
+#endif
+      }
 
-        archive_mean /= archive_size;
-        mean_dist_center /= archive_size;
-        ofs << ea.gen() << " " << archive_size << " " << archive_mean << " " << archive_max << " " << mean_dist_center << std::endl;
+      template<typename S>
+      progress_t _progress(size_t gen, const S& stats) const {
+        progress_t p;
+        p.gen = gen;
+        p.size = stats.size;
+        p.mean = stats.mean();
+        p.max = stats.max_fit;
+        p.mean_dist_center = stats.mean_dist_center();
+        p.qd_score = stats.qd_score();
+        p.coverage = stats.coverage();
+        return p;
       }
 
 
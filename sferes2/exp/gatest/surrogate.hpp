@@ -0,0 +1,125 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+#ifndef SURROGATE_HPP_
+#define SURROGATE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <tuple>
+#include <vector>
+
+#include <Eigen/Core>
+#include <limbo/macros.hpp>
+#include <limbo/gp.hpp>
+
+namespace sferes {
+  namespace ea {
+    // Surrogate of the evaluation for MAP-Elites: genome -> (fitness,
+    // descriptor), one limbo GP per output sharing the same samples. It is
+    // updated with every evaluated individual but only the last
+    // Params::surrogate::nb_samples are kept, since training a GP is cubic
+    // in the number of samples.
+    //
+    // Params::surrogate: nb_samples, min_samples (no prediction before),
+    // noise (of the GPs); Params::kf_maternfivehalfs: sigma(), l() (limbo
+    // kernel)
+    template<typename Params>
+    class Surrogate {
+    public:
+      typedef limbo::model::GP<Params, limbo::kernel_functions::MaternFiveHalfs<Params>,
+              limbo::mean_functions::MeanData<Params> > gp_t;
+      struct prediction_t {
+        float fit;
+        // standard deviation of the fitness
+        float sigma;
+        std::vector<float> desc;
+      };
+
+      void add(const std::vector<float>& genome, float fit, const std::vector<float>& desc) {
+        Eigen::VectorXd x(genome.size());
+        for (size_t i = 0; i < genome.size(); ++i)
+          x(i) = genome[i];
+        std::vector<double> y(1, fit);
+        y.insert(y.end(), desc.begin(), desc.end());
+        _samples.push_back(x);
+        _observations.push_back(y);
+        if (_samples.size() > Params::surrogate::nb_samples) {
+          _samples.pop_front();
+          _observations.pop_front();
+        }
+      }
+      // retrains the GPs on the current samples
+      void train() {
+        if (!ready())
+          return;
+        std::vector<Eigen::VectorXd> samples(_samples.begin(), _samples.end());
+        size_t nb_outputs = _observations.front().size();
+        _gps.resize(nb_outputs);
+        std::vector<double> obs(samples.size());
+        for (size_t j = 0; j < nb_outputs; ++j) {
+          for (size_t i = 0; i < obs.size(); ++i)
+            obs[i] = _observations[i][j];
+          _gps[j].compute(samples, obs, Params::surrogate::noise);
+        }
+      }
+      bool ready() const {
+        return _samples.size() >= Params::surrogate::min_samples;
+      }
+      // the descriptor is clipped to [0, 1]
+      prediction_t predict(const std::vector<float>& genome) const {
+        assert(!_gps.empty());
+        Eigen::VectorXd x(genome.size());
+        for (size_t i = 0; i < genome.size(); ++i)
+          x(i) = genome[i];
+        prediction_t p;
+        double mu, var;
+        std::tie(mu, var) = _gps[0].query(x);
+        p.fit = mu;
+        p.sigma = sqrt(std::max(0.0, var));
+        for (size_t j = 1; j < _gps.size(); ++j)
+          p.desc.push_back(std::max(0.0, std::min(1.0, _gps[j].mu(x))));
+        return p;
+      }
+    protected:
+      std::deque<Eigen::VectorXd> _samples;
+      // fitness, then descriptor
+      std::deque<std::vector<double> > _observations;
+      std::vector<gp_t> _gps;
+    };
+  }
+}
+#endif
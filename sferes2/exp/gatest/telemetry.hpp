@@ -0,0 +1,289 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+#ifndef TELEMETRY_HPP_
+#define TELEMETRY_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "progress_sink.hpp"
+
+namespace sferes {
+  namespace stat {
+    // Opt-in live metrics for long runs (gatest --telemetry <file>).
+    // The evaluation threads and the EA only update relaxed atomic
+    // counters; a background thread rewrites <file> (JSON, replaced
+    // atomically with rename) every period_ms with:
+    // - evaluations and rollouts per second (over the last period)
+    // - the utilization of each evaluation thread (time spent in rollouts
+    //   / period; a rollout is counted in the period where it ends)
+    // - the last archive progress (size, coverage, QD-score, max)
+    // - the median / 90th / 99th percentile of the rollout time (over the
+    //   last period), from a log-scale histogram (4 buckets per octave)
+    // When telemetry is not started, the hooks cost one relaxed load.
+    class Telemetry : boost::noncopyable {
+    public:
+      typedef std::chrono::steady_clock steady_t;
+      static const size_t max_threads = 256;
+      static const size_t nb_buckets = 128;
+
+      static Telemetry& instance() {
+        static Telemetry t;
+        return t;
+      }
+      static bool enabled() {
+        return instance()._enabled.load(std::memory_order_relaxed);
+      }
+
+      void start(const std::string& fname, int period_ms = 2000) {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_thread)
+          return;
+        _fname = fname;
+        _period_ms = period_ms;
+        _start = _last = steady_t::now();
+        _thread.reset(new boost::thread(&Telemetry::_run, this));
+        _enabled.store(true, std::memory_order_relaxed);
+      }
+      // writes the last report and stops the background thread
+      void stop() {
+        {
+          boost::mutex::scoped_lock lock(_mutex);
+          if (!_thread)
+            return;
+          _stop = true;
+        }
+        _cond.notify_one();
+        _thread->join();
+        _thread.reset();
+        _enabled.store(false, std::memory_order_relaxed);
+      }
+      ~Telemetry() {
+        stop();
+      }
+
+      // evaluation threads
+      void rollout(double seconds) {
+        _slot& s = _slots[_thread_slot()];
+        s.busy_ns.fetch_add((unsigned long long)(seconds * 1e9), std::memory_order_relaxed);
+        _rollouts.fetch_add(1, std::memory_order_relaxed);
+        _hist[_bucket(seconds)].fetch_add(1, std::memory_order_relaxed);
+      }
+      void eval() {
+        _evals.fetch_add(1, std::memory_order_relaxed);
+      }
+      // EA thread
+      void progress(const progress_t& p) {
+        _gen.store(p.gen, std::memory_order_relaxed);
+        _size.store(p.size, std::memory_order_relaxed);
+        _coverage.store(p.coverage, std::memory_order_relaxed);
+        _qd_score.store(p.qd_score, std::memory_order_relaxed);
+        _max.store(p.max, std::memory_order_relaxed);
+      }
+
+      // times a rollout (no-op if telemetry is not started)
+      class ScopedRollout : boost::noncopyable {
+      public:
+        ScopedRollout() : _on(Telemetry::enabled()) {
+          if (_on)
+            _t0 = steady_t::now();
+        }
+        ~ScopedRollout() {
+          if (_on)
+            Telemetry::instance().rollout(std::chrono::duration<double>(steady_t::now() - _t0).count());
+        }
+      protected:
+        bool _on;
+        steady_t::time_point _t0;
+      };
+
+      // lower bound (in seconds) of bucket b
+      static double bucket_min(size_t b) {
+        return b == 0 ? 0 : 1e-6 * std::pow(2.0, (b - 1) / 4.0);
+      }
+
+    protected:
+      // one cache line per thread
+      struct alignas(64) _slot {
+        std::atomic<unsigned long long> busy_ns;
+        _slot() : busy_ns(0) {}
+      };
+
+      std::atomic<bool> _enabled;
+      std::atomic<unsigned long long> _evals, _rollouts;
+      std::atomic<unsigned long> _gen, _size;
+      std::atomic<float> _coverage, _qd_score, _max;
+      std::atomic<unsigned long long> _hist[nb_buckets];
+      std::atomic<size_t> _nb_slots;
+      _slot _slots[max_threads];
+
+      std::string _fname;
+      int _period_ms;
+      bool _stop;
+      boost::mutex _mutex;
+      boost::condition_variable _cond;
+      boost::scoped_ptr<boost::thread> _thread;
+      // only touched by the background thread
+      steady_t::time_point _start, _last;
+      unsigned long long _last_evals, _last_rollouts;
+      std::vector<unsigned long long> _last_busy, _last_hist;
+
+      Telemetry() :
+        _enabled(false), _evals(0), _rollouts(0), _gen(0), _size(0),
+        _coverage(0), _qd_score(0), _max(0), _nb_slots(0),
+        _period_ms(2000), _stop(false),
+        _last_evals(0), _last_rollouts(0),
+        _last_busy(max_threads, 0), _last_hist(nb_buckets, 0) {
+        for (size_t i = 0; i < nb_buckets; ++i)
+          _hist[i].store(0);
+      }
+
+      // each thread gets its own slot the first time it reports (threads
+      // beyond max_threads share the last one)
+      size_t _thread_slot() {
+        static thread_local size_t slot = max_threads;
+        if (slot == max_threads) {
+          slot = _nb_slots.fetch_add(1, std::memory_order_relaxed);
+          if (slot >= max_threads)
+            slot = max_threads - 1;
+        }
+        return slot;
+      }
+      static size_t _bucket(double seconds) {
+        double us = seconds * 1e6;
+        if (us < 1)
+          return 0;
+        size_t b = (size_t)(4 * std::log2(us)) + 1;
+        return b < nb_buckets ? b : nb_buckets - 1;
+      }
+
+      void _run() {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (true) {
+          if (!_stop)
+            _cond.timed_wait(lock, boost::posix_time::milliseconds(_period_ms));
+          bool stop = _stop;
+          lock.unlock();
+          _report();
+          lock.lock();
+          if (stop)
+            break;
+        }
+        _stop = false;
+      }
+
+      // percentile q of the histogram h (geometric middle of the bucket)
+      static double _percentile(const std::vector<unsigned long long>& h,
+                                unsigned long long total, double q) {
+        if (total == 0)
+          return 0;
+        unsigned long long n = 0;
+        for (size_t b = 0; b < h.size(); ++b) {
+          n += h[b];
+          if (n >= q * total)
+            return b == 0 ? 0 : std::sqrt(bucket_min(b) * bucket_min(b + 1));
+        }
+        return bucket_min(h.size() - 1);
+      }
+
+      void _report() {
+        steady_t::time_point now = steady_t::now();
+        double dt = std::chrono::duration<double>(now - _last).count();
+        double elapsed = std::chrono::duration<double>(now - _start).count();
+        _last = now;
+        if (dt <= 0)
+          dt = 1e-9;
+
+        unsigned long long evals = _evals.load(std::memory_order_relaxed);
+        unsigned long long rollouts = _rollouts.load(std::memory_order_relaxed);
+        std::vector<unsigned long long> hist(nb_buckets);
+        unsigned long long nb_window = 0;
+        for (size_t b = 0; b < nb_buckets; ++b) {
+          unsigned long long v = _hist[b].load(std::memory_order_relaxed);
+          hist[b] = v - _last_hist[b];
+          nb_window += hist[b];
+          _last_hist[b] = v;
+        }
+
+        std::string tmp = _fname + ".tmp";
+        {
+          std::ofstream ofs(tmp.c_str());
+          ofs << "{\n"
+              << "  \"time\": " << elapsed << ",\n"
+              << "  \"gen\": " << _gen.load(std::memory_order_relaxed) << ",\n"
+              << "  \"evals\": " << evals << ",\n"
+              << "  \"evals_per_sec\": " << (evals - _last_evals) / dt << ",\n"
+              << "  \"rollouts\": " << rollouts << ",\n"
+              << "  \"rollouts_per_sec\": " << (rollouts - _last_rollouts) / dt << ",\n"
+              << "  \"thread_utilization\": [";
+          size_t nb_slots = std::min(_nb_slots.load(std::memory_order_relaxed), max_threads);
+          for (size_t i = 0; i < nb_slots; ++i) {
+            unsigned long long busy = _slots[i].busy_ns.load(std::memory_order_relaxed);
+            ofs << (i ? ", " : "") << (busy - _last_busy[i]) * 1e-9 / dt;
+            _last_busy[i] = busy;
+          }
+          ofs << "],\n"
+              << "  \"archive\": {\"size\": " << _size.load(std::memory_order_relaxed)
+              << ", \"coverage\": " << _coverage.load(std::memory_order_relaxed)
+              << ", \"qd_score\": " << _qd_score.load(std::memory_order_relaxed)
+              << ", \"max\": " << _max.load(std::memory_order_relaxed) << "},\n"
+              << "  \"rollout_time\": {\"count\": " << nb_window
+              << ", \"p50\": " << _percentile(hist, nb_window, 0.5)
+              << ", \"p90\": " << _percentile(hist, nb_window, 0.9)
+              << ", \"p99\": " << _percentile(hist, nb_window, 0.99) << "}\n"
+              << "}\n";
+        }
+        std::rename(tmp.c_str(), _fname.c_str());
+        _last_evals = evals;
+        _last_rollouts = rollouts;
+      }
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,227 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+
+
+#ifndef BIPOP_CMAES_HPP_
+#define BIPOP_CMAES_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <boost/foreach.hpp>
+#include <boost/static_assert.hpp>
+#include <sferes/stc.hpp>
+#include <sferes/ea/ea.hpp>
+#include <sferes/fit/fitness.hpp>
+#include <sferes/parallel.hpp>
+#include "cmaes_interface.h"
+
+namespace sferes {
+
+  namespace ea {
+
+    namespace cmaes_restart {
+      enum restart_t { ipop = 0, bipop };
+    }
+
+    // CMA-ES with restarts. Several independent CMA-ES instances are
+    // sampled into the same population so that each generation is
+    // evaluated as a single batch (this keeps all the threads busy even
+    // when lambda is small). An instance that meets a termination
+    // criterion is restarted from a random point:
+    // - ipop: lambda is doubled at each restart
+    // - bipop: alternate between a large-population regime (ipop) and a
+    //   small-population regime with a smaller, random step-size; the
+    //   regime that used the fewest evaluations so far is selected
+    //
+    // REFERENCES:
+    // Auger, A. and N. Hansen (2005). A Restart CMA Evolution Strategy
+    // With Increasing Population Size. IEEE CEC 2005, pp. 1769-1776.
+    // Hansen, N. (2009). Benchmarking a BI-Population CMA-ES on the
+    // BBOB-2009 Function Testbed. GECCO 2009 (workshop), pp. 2389-2396.
+    //
+    // required parameters:
+    // struct cmaes {
+    //   SFERES_CONST size_t nb_instances = 4;
+    //   SFERES_CONST cmaes_restart::restart_t restart = cmaes_restart::bipop;
+    //   SFERES_CONST float sigma = 0.5f; // initial step-size (genotype)
+    // };
+    SFERES_EA(BipopCmaes, Ea) {
+    public:
+      SFERES_CONST size_t dim = Phen::gen_t::gen_size;
+      SFERES_CONST size_t nb_instances = Params::cmaes::nb_instances;
+      // the population is not allowed to grow beyond 2^max_doublings * lambda
+      SFERES_CONST size_t max_doublings = 9;
+
+      BipopCmaes() :
+        _default_lambda(4 + (int)(3 * log((double)dim))),
+        _instances(nb_instances),
+        _dirty(true) {
+        BOOST_STATIC_ASSERT(nb_instances > 0);
+      }
+      ~BipopCmaes() {
+        BOOST_FOREACH(instance_t& inst, _instances)
+        if (inst.lambda)
+          cmaes_exit(&inst.evo);
+      }
+      void random_pop() {
+        for (size_t k = 0; k < _instances.size(); ++k)
+          _start(_instances[k], _default_lambda, Params::cmaes::sigma);
+        _layout();
+      }
+      void epoch() {
+        // a restart may have changed the size of the population
+        if (_dirty)
+          _layout();
+        // sample (each genotype is written once and developed once)
+        BOOST_FOREACH(instance_t& inst, _instances) {
+          double* const* x = cmaes_SamplePopulation(&inst.evo);
+          for (size_t i = 0; i < inst.lambda; ++i) {
+            Phen& p = *this->_pop[inst.offset + i];
+            for (size_t j = 0; j < dim; ++j)
+              p.gen().data(j, x[i][j]);
+            p.develop();
+          }
+        }
+        // eval all the instances in a single batch
+        this->_eval_pop(this->_pop, 0, this->_pop.size());
+        this->apply_modifier();
+        for (size_t i = 0; i < this->_pop.size(); ++i) {
+          //warning: CMAES minimizes the fitness...
+          _funvals[i] = - this->_pop[i]->fit().value();
+          // individuals are recycled, so the best one is copied
+          if (!_best || this->_pop[i]->fit().value() > _best->fit().value())
+            _best = boost::shared_ptr<Phen>(new Phen(*this->_pop[i]));
+        }
+        // update each instance from its slice of the fitness buffer
+        BOOST_FOREACH(instance_t& inst, _instances) {
+          cmaes_UpdateDistribution(&inst.evo, &_funvals[inst.offset]);
+          if (inst.large)
+            inst.evals_large += inst.lambda;
+          else
+            inst.evals_small += inst.lambda;
+          if (cmaes_TestForTermination(&inst.evo))
+            _restart(inst);
+        }
+      }
+      size_t nb_restarts() const {
+        size_t n = 0;
+        BOOST_FOREACH(const instance_t& inst, _instances)
+        n += inst.restarts;
+        return n;
+      }
+      // best individual since the beginning (over all the restarts)
+      const boost::shared_ptr<Phen>& best() const {
+        return _best;
+      }
+      // current population size of instance k
+      size_t lambda(size_t k) const {
+        assert(k < _instances.size());
+        return _instances[k].lambda;
+      }
+    protected:
+      struct instance_t {
+        instance_t() : lambda(0), offset(0), large(true),
+          nb_large(0), restarts(0), evals_large(0), evals_small(0) {
+          // cmaes_init() expects a zeroed structure
+          memset(&evo, 0, sizeof(cmaes_t));
+        }
+        cmaes_t evo;
+        size_t lambda;
+        size_t offset;
+        bool large;
+        size_t nb_large;
+        size_t restarts;
+        size_t evals_large, evals_small;
+      };
+
+      size_t _default_lambda;
+      std::vector<instance_t> _instances;
+      std::vector<double> _funvals;
+      boost::shared_ptr<Phen> _best;
+      bool _dirty;
+
+      void _start(instance_t& inst, size_t lambda, double sigma) {
+        std::vector<double> xstart(dim), stddev(dim, sigma);
+        for (size_t j = 0; j < dim; ++j)
+          xstart[j] = misc::rand<double>();
+        if (inst.lambda)
+          cmaes_exit(&inst.evo);
+        // "non": do not read or write any parameter file
+        cmaes_init(&inst.evo, dim, &xstart[0], &stddev[0],
+                   misc::rand<long>(1, 1L << 30), lambda, "non");
+        inst.lambda = (size_t) cmaes_Get(&inst.evo, "lambda");
+        _dirty = true;
+      }
+
+      void _restart(instance_t& inst) {
+        ++inst.restarts;
+        if (Params::cmaes::restart == cmaes_restart::ipop
+            || inst.evals_large <= inst.evals_small) {
+          inst.nb_large = std::min(inst.nb_large + 1, max_doublings);
+          inst.large = true;
+          _start(inst, _default_lambda << inst.nb_large, Params::cmaes::sigma);
+        } else {
+          // small regime: lambda in [default, large / 2], smaller step-size
+          float u = misc::rand<float>();
+          double l = 0.5 * (_default_lambda << inst.nb_large) / _default_lambda;
+          size_t lambda = (size_t)(_default_lambda * pow(l, u * u));
+          inst.large = false;
+          _start(inst, std::max(lambda, _default_lambda),
+                 Params::cmaes::sigma * pow(10.0, -2.0 * u));
+        }
+      }
+
+      // assign a slice of the population to each instance; individuals
+      // are kept from one layout to the next, only new slots are allocated
+      void _layout() {
+        size_t size = 0;
+        BOOST_FOREACH(instance_t& inst, _instances) {
+          inst.offset = size;
+          size += inst.lambda;
+        }
+        this->_pop.resize(size);
+        for (size_t i = 0; i < size; ++i)
+          if (!this->_pop[i])
+            this->_pop[i] = boost::shared_ptr<Phen>(new Phen());
+        _funvals.resize(size);
+        _dirty = false;
+      }
+    };
+  }
+}
+#endif
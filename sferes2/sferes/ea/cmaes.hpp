@@ -36,6 +36,7 @@
 #define CMAES_HPP_
 
 #include <algorithm>
+#include <cstring>
 #include <boost/foreach.hpp>
 #include <sferes/stc.hpp>
 #include <sferes/ea/ea.hpp>
@@ -50,6 +51,8 @@ namespace sferes {
     SFERES_EA(Cmaes, Ea) {
     public:
       Cmaes() {
+        // cmaes_init() expects a zeroed structure
+        memset(&_evo, 0, sizeof(cmaes_t));
         _ar_funvals = cmaes_init(&_evo, dim, NULL, NULL, 0, 0, NULL);
         _lambda = cmaes_Get(&_evo, "lambda"); // default lambda (pop size)
       }
@@ -67,11 +70,11 @@ namespace sferes {
         //
         _cmaes_pop = cmaes_SamplePopulation(&_evo);
         // copy pop
-        for (size_t i = 0; i < this->_pop.size(); ++i)
-          for (size_t j = 0; j < this->_pop[i]->size(); ++j) {
+        for (size_t i = 0; i < this->_pop.size(); ++i) {
+          for (size_t j = 0; j < this->_pop[i]->size(); ++j)
             this->_pop[i]->gen().data(j, _cmaes_pop[i][j]);
-            this->_pop[i]->develop();
-          }
+          this->_pop[i]->develop();
+        }
         // eval
         this->_eval_pop(this->_pop, 0, this->_pop.size());
         this->apply_modifier();
@@ -54,11 +54,18 @@
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/bind/bind.hpp>
 
 #include <sferes/dbg/dbg.hpp>
 #include <sferes/misc.hpp>
+#include <sferes/misc/async_writer.hpp>
+#include <sferes/misc/stat_format.hpp>
 #include <sferes/stc.hpp>
 
 #ifndef VERSION
@@ -154,22 +161,32 @@ namespace sferes {
             boost::fusion::vector<FitModifier> >::type modifier_t;
       typedef std::vector<boost::shared_ptr<Phen> > pop_t;
       typedef typename phen_t::fit_t fit_t;
-      Ea() : _pop(Params::pop::size), _gen(0) {
+      Ea() : _pop(Params::pop::size), _gen(0), _format(misc::xml) {
         _make_res_dir();
       }
+      ~Ea() {
+        flush();
+      }
       void set_fit_proto(const fit_t& fit) {
         _fit_proto = fit;
       }
 
+      // when run by run_ea, SIGINT/SIGTERM stop the run at the end of the
+      // current generation (which is written)
       void run() {
         dbg::trace trace("ea", DBG_HERE);
         random_pop();
         for (_gen = 0; _gen < Params::pop::nb_gen; ++_gen) {
           epoch();
           update_stats();
-          if (_gen % Params::pop::dump_period == 0)
+          if (_gen % Params::pop::dump_period == 0 || misc::interrupted())
             _write(_gen);
+          if (misc::interrupted()) {
+            std::cerr << "interrupted at generation " << _gen << std::endl;
+            break;
+          }
         }
+        flush();
       }
       void random_pop() {
         dbg::trace trace("ea", DBG_HERE);
@@ -208,9 +225,17 @@ namespace sferes {
       const typename boost::fusion::result_of::value_at_c<Stat, I>::type& stat() const {
         return boost::fusion::at_c<I>(_stat);
       }
+      // the format is detected when loading
       void load(const std::string& fname) {
         _load(fname);
       }
+      // format of the generation files (xml by default)
+      void set_format(misc::stat_format_t format) {
+        _format = format;
+      }
+      misc::stat_format_t format() const {
+        return _format;
+      }
       void show_stat(unsigned i, std::ostream& os, size_t k = 0) {
         boost::fusion::for_each(_stat, ShowStat_f(i, os, k));
       }
@@ -232,6 +257,16 @@ namespace sferes {
       void write(size_t g) const {
         _write(g);
       }
+      // true if the stats can be written in the background from a copy:
+      // the individuals they point to must not be modified afterwards
+      // (Exact can redefine it)
+      bool async_write() const {
+        return false;
+      }
+      // wait for the background writes
+      void flush() const {
+        misc::AsyncWriter::flush_instance();
+      }
      protected:
       pop_t _pop;
       eval_t _eval;
@@ -240,6 +275,7 @@ namespace sferes {
       std::string _res_dir;
       size_t _gen;
       fit_t _fit_proto;
+      misc::stat_format_t _format;
 
       template<typename P>
       void _eval_pop(P& p, size_t start, size_t end) {
@@ -260,24 +296,67 @@ namespace sferes {
           return;
         std::string fname = _res_dir + std::string("/gen_")
                             + boost::lexical_cast<std::string>(gen);
-        std::ofstream ofs(fname.c_str());
-        typedef boost::archive::xml_oarchive oa_t;
-        oa_t oa(ofs);
-        boost::fusion::for_each(_stat, WriteStat_f<oa_t>(oa));
+        if (stc::exact(this)->async_write()) {
+          // the copy of the stats is written while the next generations
+          // are computed
+          boost::shared_ptr<const stat_t> snapshot(new stat_t(_stat));
+          misc::AsyncWriter::instance().push(boost::bind(&Ea::_write_snapshot, snapshot,
+                                             fname, _format));
+        } else
+          _write_stats(_stat, fname, _format);
+      }
+      static void _write_snapshot(boost::shared_ptr<const stat_t> stat,
+                                  const std::string& fname,
+                                  misc::stat_format_t format) {
+        _write_stats(*stat, fname, format);
+      }
+      static void _write_stats(const stat_t& stat, const std::string& fname,
+                               misc::stat_format_t format) {
+        namespace io = boost::iostreams;
+        std::ofstream ofs(fname.c_str(), std::ios::out | std::ios::binary);
+        if (format == misc::xml) {
+          typedef boost::archive::xml_oarchive oa_t;
+          oa_t oa(ofs);
+          boost::fusion::for_each(stat, WriteStat_f<oa_t>(oa));
+        } else {
+          misc::write_stat_header(ofs, format);
+          io::filtering_ostream out;
+          if (format == misc::binary_gz)
+            out.push(io::gzip_compressor());
+          out.push(ofs);
+          typedef boost::archive::binary_oarchive oa_t;
+          // the archive must be closed before the stream
+          {
+            oa_t oa(out);
+            boost::fusion::for_each(stat, WriteStat_f<oa_t>(oa));
+          }
+        }
         std::cout << fname << " written" << std::endl;
       }
       void _load(const std::string& fname) {
         dbg::trace trace("ea", DBG_HERE);
+        namespace io = boost::iostreams;
         std::cout << "loading " << fname << std::endl;
-        std::ifstream ifs(fname.c_str());
+        std::ifstream ifs(fname.c_str(), std::ios::in | std::ios::binary);
         if (ifs.fail()) {
           std::cerr << "Cannot open :" << fname
                     << "(does file exist ?)" << std::endl;
           exit(1);
         }
-        typedef boost::archive::xml_iarchive ia_t;
-        ia_t ia(ifs);
-        boost::fusion::for_each(_stat, ReadStat_f<ia_t>(ia));
+        misc::stat_format_t format = misc::read_stat_header(ifs);
+        if (format == misc::xml) {
+          typedef boost::archive::xml_iarchive ia_t;
+          ia_t ia(ifs);
+          boost::fusion::for_each(_stat, ReadStat_f<ia_t>(ia));
+        } else {
+          io::filtering_istream in;
+          if (format == misc::binary_gz)
+            in.push(io::gzip_decompressor());
+          in.push(ifs);
+          typedef boost::archive::binary_iarchive ia_t;
+          ia_t ia(in);
+          boost::fusion::for_each(_stat, ReadStat_f<ia_t>(ia));
+        }
       }
     };
   }
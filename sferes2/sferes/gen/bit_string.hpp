@@ -41,6 +41,8 @@
 #include <vector>
 #include <limits>
 #include <bitset>
+#include <cmath>
+#include <stdint.h>
 #include <boost/foreach.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/nvp.hpp>
@@ -87,64 +89,83 @@ namespace sferes {
 
     }
     /// in range [0;1]
+    /// the Size values of nb_bits bits are packed in 64-bit words (value i
+    /// is made of the bits [i * nb_bits, (i + 1) * nb_bits), least
+    /// significant first)
     template<int Size, typename Params, typename Exact = stc::Itself>
     class BitString : public stc::Any<Exact> {
      public:
       typedef Params params_t;
       typedef BitString<Size, Params, Exact> this_t;
       typedef std::bitset<Params::bit_string::nb_bits> bs_t;
+      typedef uint64_t word_t;
+      SFERES_CONST size_t nb_bits = Params::bit_string::nb_bits;
+      SFERES_CONST size_t word_bits = 64;
+      SFERES_CONST size_t nb_words = (Size * nb_bits + word_bits - 1) / word_bits;
       SFERES_CONST double bs_max = _bitstring::_pow<2, Params::bit_string::nb_bits>::result - 1;
 
-      BitString() : _data(Size) {
+      BitString() : _data(nb_words, 0) {
       }
 
       //@{
+      // each value is mutated with probability mutation_rate, then each
+      // of its bits with probability mutation_rate_bit: the mutated
+      // values and bits are found by drawing the gaps between them
+      // (geometric distribution) instead of one number per bit
       void mutate() {
-        BOOST_FOREACH(bs_t & b, _data)
-        if (misc::rand<float>() < Params::bit_string::mutation_rate)
-          for (size_t i = 0; i < b.size(); ++i)
-            if (misc::rand<float>() < Params::bit_string::mutation_rate_bit)
-              b[i].flip();
+        const float p = Params::bit_string::mutation_rate;
+        const float p_bit = Params::bit_string::mutation_rate_bit;
+        for (size_t i = _skip(p, Size); i < Size; i += 1 + _skip(p, Size))
+          for (size_t j = _skip(p_bit, nb_bits); j < nb_bits; j += 1 + _skip(p_bit, nb_bits))
+            _flip(i * nb_bits + j);
       }
-      // 1-point cross-over
+      // 1-point cross-over in each value (the first bits come from one
+      // parent, the others from the other one)
       void cross(const BitString& o, BitString& c1, BitString& c2) {
-        assert(Size == _data.size());
         assert(c1._data.size() == _data.size());
         assert(c2._data.size() == _data.size());
 
-        for (size_t i = 0; i < c1._data.size(); ++i) {
-          size_t k = misc::rand(c1._data.size());
-          for (size_t j = 0; j < c1._data[i].size(); ++j)
-            if (j < k) {
-              c1._data[i][j] = _data[i][j];
-              c2._data[i][j] = o._data[i][j];
-            } else {
-              c1._data[i][j] = o._data[i][j];
-              c2._data[i][j] = _data[i][j];
-            }
+        std::vector<word_t> mask(nb_words, 0);
+        for (size_t i = 0; i < Size; ++i)
+          _set_range(mask, i * nb_bits, i * nb_bits + misc::rand(nb_bits));
+        for (size_t w = 0; w < nb_words; ++w) {
+          c1._data[w] = (_data[w] & mask[w]) | (o._data[w] & ~mask[w]);
+          c2._data[w] = (o._data[w] & mask[w]) | (_data[w] & ~mask[w]);
         }
       }
       void random() {
-        BOOST_FOREACH(bs_t & v, _data)
-        for (size_t i = 0; i < v.size(); ++i)
-          v[i] = (int) misc::flip_coin();
+        BOOST_FOREACH(word_t & w, _data) {
+          w = 0;
+          for (size_t k = 0; k < word_bits; k += 16)
+            w |= word_t(misc::rand<unsigned>(1 << 16)) << k;
+        }
+        // the bits after the last value stay at 0
+        if ((Size * nb_bits) % word_bits)
+          _data.back() &= _mask((Size * nb_bits) % word_bits);
       }
       //@}
 
       //@{
       float data(size_t i) const {
         assert(bs_max != 0);
-        assert(i < _data.size());
-        return _to_double(_data[i]) / bs_max;
+        assert(i < Size);
+        double x = 0;
+        for (size_t k = 0; k < nb_bits; k += word_bits)
+          x += std::ldexp((double) _get(i * nb_bits + k, _min(word_bits, nb_bits - k)), k);
+        return x / bs_max;
       }
+      // the first 64 bits of value i
       unsigned long int_data(size_t i) const {
-        assert(i < _data.size());
-        return _data[i].to_ulong();
+        assert(i < Size);
+        return _get(i * nb_bits, _min(word_bits, nb_bits));
       }
 
       bs_t bs_data(size_t i) const {
-        assert(i < _data.size());
-        return _data[i];
+        assert(i < Size);
+        bs_t b;
+        for (size_t j = 0; j < nb_bits; ++j)
+          b[j] = _bit(i * nb_bits + j);
+        return b;
       }
 
       size_t size() const {
@@ -155,19 +176,50 @@ namespace sferes {
       template<class Archive>
       void serialize(Archive& ar, const unsigned int version) {
         ar& BOOST_SERIALIZATION_NVP(_data);
+        assert(_data.size() == nb_words);
       }
      protected:
-      template<size_t N>
-      double _to_double(const std::bitset<N>& d) const {
-        double x = 0;
-        size_t k = 1;
-        for (size_t i = 0; i < N; ++i) {
-          x += d[i] * k;
-          k *= 2;
+      std::vector<word_t> _data;
+
+      static size_t _min(size_t a, size_t b) {
+        return a < b ? a : b;
+      }
+      static word_t _mask(size_t n) {
+        return n >= word_bits ? ~word_t(0) : (word_t(1) << n) - 1;
+      }
+      bool _bit(size_t b) const {
+        return (_data[b / word_bits] >> (b % word_bits)) & 1;
+      }
+      void _flip(size_t b) {
+        _data[b / word_bits] ^= word_t(1) << (b % word_bits);
+      }
+      // the n <= 64 bits from bit b
+      word_t _get(size_t b, size_t n) const {
+        size_t w = b / word_bits, s = b % word_bits;
+        word_t v = _data[w] >> s;
+        if (s + n > word_bits)
+          v |= _data[w + 1] << (word_bits - s);
+        return v & _mask(n);
+      }
+      // sets the bits [b, e) of m
+      static void _set_range(std::vector<word_t>& m, size_t b, size_t e) {
+        while (b < e) {
+          size_t s = b % word_bits;
+          size_t n = _min(word_bits - s, e - b);
+          m[b / word_bits] |= _mask(n) << s;
+          b += n;
         }
-        return x;
       }
-      std::vector<bs_t> _data;
+      // number of failures before the next success of probability p
+      // (at most n)
+      static size_t _skip(float p, size_t n) {
+        if (p >= 1.0f)
+          return 0;
+        if (p <= 0.0f)
+          return n;
+        double k = std::floor(std::log(1.0 - misc::rand<double>()) / std::log(1.0 - p));
+        return k < n ? size_t(k) : n;
+      }
     };
 
   } // gen
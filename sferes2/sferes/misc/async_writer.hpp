@@ -0,0 +1,166 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+
+
+
+#ifndef ASYNC_WRITER_HPP_
+#define ASYNC_WRITER_HPP_
+
+#include <csignal>
+#include <deque>
+#include <exception>
+#include <iostream>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace sferes {
+  namespace misc {
+    // Runs write jobs (dumps of snapshots) in a background thread, in the
+    // order they were pushed. The queue is bounded: push() blocks while
+    // max_jobs jobs are pending, so at most max_jobs snapshots are alive
+    // besides the state being computed.
+    class AsyncWriter : boost::noncopyable {
+     public:
+      typedef boost::function<void()> job_t;
+
+      AsyncWriter(size_t max_jobs = 2) :
+        _max_jobs(max_jobs), _busy(false), _stop(false),
+        _thread(&AsyncWriter::_run, this) {
+      }
+      ~AsyncWriter() {
+        {
+          boost::mutex::scoped_lock lock(_mutex);
+          _stop = true;
+        }
+        _cond.notify_all();
+        _thread.join();
+      }
+      void push(const job_t& job) {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (_jobs.size() >= _max_jobs)
+          _cond.wait(lock);
+        _jobs.push_back(job);
+        _cond.notify_all();
+      }
+      // wait until every pushed job is done
+      void flush() {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (!_jobs.empty() || _busy)
+          _cond.wait(lock);
+      }
+      // writer shared by the EA and the statistics (the pending jobs are
+      // done when it is destroyed, i.e. at exit)
+      static AsyncWriter& instance() {
+        static AsyncWriter writer;
+        _created() = true;
+        return writer;
+      }
+      // flush the shared writer if it has been used
+      static void flush_instance() {
+        if (_created())
+          instance().flush();
+      }
+     protected:
+      size_t _max_jobs;
+      bool _busy;
+      bool _stop;
+      std::deque<job_t> _jobs;
+      boost::mutex _mutex;
+      boost::condition_variable _cond;
+      boost::thread _thread;
+
+      static bool& _created() {
+        static bool created = false;
+        return created;
+      }
+
+      void _run() {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (true) {
+          while (_jobs.empty() && !_stop)
+            _cond.wait(lock);
+          if (_jobs.empty())
+            return;
+          job_t job = _jobs.front();
+          _jobs.pop_front();
+          _busy = true;
+          _cond.notify_all();
+          lock.unlock();
+          try {
+            job();
+          } catch (std::exception& e) {
+            std::cerr << "error while writing: " << e.what() << std::endl;
+          }
+          lock.lock();
+          _busy = false;
+          _cond.notify_all();
+        }
+      }
+    };
+
+    // Once catch_interrupt() has been called (by run_ea), SIGINT/SIGTERM
+    // only raise a flag (checked by Ea::run, which then writes the current
+    // generation and stops); a second signal kills the process as usual.
+    // The flag is never cleared: an EA run afterwards in the same process
+    // stops after its first generation.
+    inline volatile std::sig_atomic_t& interrupted_flag() {
+      static volatile std::sig_atomic_t flag = 0;
+      return flag;
+    }
+    inline bool interrupted() {
+      return interrupted_flag() != 0;
+    }
+    extern "C" inline void _on_interrupt(int sig) {
+      interrupted_flag() = 1;
+      std::signal(sig, SIG_DFL);
+    }
+    // call it once, from the main thread
+    inline void catch_interrupt() {
+      static bool installed = false;
+      if (installed)
+        return;
+      installed = true;
+      std::signal(SIGINT, &_on_interrupt);
+      std::signal(SIGTERM, &_on_interrupt);
+    }
+  }
+}
+
+#endif
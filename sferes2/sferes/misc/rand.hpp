@@ -50,13 +50,29 @@
 // someday we will have a real thread-safe random number generator...
 namespace sferes {
   namespace misc {
-    // NOT Thread-safe !
+    // source of uniform numbers in [0, 1) installed by a caller that
+    // needs its own stream (e.g. one per replicate, see limbo's
+    // misc::ScopedGenerator); uniform(state) is called for each number
+    struct rand_source_t {
+      double (*uniform)(void* state);
+      void* state;
+    };
+
+    // source of the calling thread; 0 (the default) means ::rand()
+    inline rand_source_t*& rand_source() {
+      static __thread rand_source_t* source = 0;
+      return source;
+    }
+
+    // NOT Thread-safe with ::rand() !
     template<typename T>
     inline T rand(T max = 1.0) {
       assert(max > 0);
+      rand_source_t* source = rand_source();
       T v;
       do
-        v = T(((double)max * ::rand())/(RAND_MAX + 1.0));
+        v = source ? T((double)max * source->uniform(source->state))
+            : T(((double)max * ::rand())/(RAND_MAX + 1.0));
       while(v >= max); // this strange case happened... precision problem?
       assert(v < max);
       return v;
@@ -0,0 +1,108 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+
+
+#ifndef STAT_FORMAT_HPP_
+#define STAT_FORMAT_HPP_
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace sferes {
+  namespace misc {
+    // Format of the generation files (gen_*).
+    // - xml: boost xml archive, human readable and portable (default)
+    // - binary: boost binary archive (much smaller and faster)
+    // - binary_gz: the binary archive compressed with gzip
+    // The binary formats start with a header (magic, schema version,
+    // flags) so that load() can detect the format. Boost binary archives
+    // are not portable across architectures / boost versions, so they are
+    // only used when asked for (--format or Ea::set_format).
+    enum stat_format_t { xml = 0, binary, binary_gz };
+
+    static const char stat_magic[] = "sferes2b";
+    static const size_t stat_magic_size = sizeof(stat_magic) - 1;
+    // to be incremented each time the layout after the header changes
+    static const boost::uint32_t stat_schema_version = 1;
+    static const boost::uint32_t stat_flag_gz = 1;
+
+    inline stat_format_t stat_format(const std::string& name) {
+      if (name == "xml")
+        return xml;
+      if (name == "binary" || name == "bin")
+        return binary;
+      if (name == "gz" || name == "binary_gz")
+        return binary_gz;
+      throw std::invalid_argument("unknown stat format: " + name
+                                  + " (xml, binary or gz)");
+    }
+
+    inline void write_stat_header(std::ostream& os, stat_format_t format) {
+      if (format == xml)
+        return;
+      boost::uint32_t flags = format == binary_gz ? stat_flag_gz : 0;
+      os.write(stat_magic, stat_magic_size);
+      os.write((const char*)&stat_schema_version, sizeof(stat_schema_version));
+      os.write((const char*)&flags, sizeof(flags));
+    }
+
+    // reads the header of a binary file; if there is no header, the
+    // stream is rewound and xml is returned
+    inline stat_format_t read_stat_header(std::istream& is) {
+      char magic[stat_magic_size];
+      is.read(magic, stat_magic_size);
+      if (!is || memcmp(magic, stat_magic, stat_magic_size)) {
+        is.clear();
+        is.seekg(0);
+        return xml;
+      }
+      boost::uint32_t version = 0, flags = 0;
+      is.read((char*)&version, sizeof(version));
+      is.read((char*)&flags, sizeof(flags));
+      if (!is || version > stat_schema_version)
+        throw std::runtime_error("unsupported stat file (schema version "
+                                 + boost::lexical_cast<std::string>(version) + ")");
+      return flags & stat_flag_gz ? binary_gz : binary;
+    }
+  }
+}
+
+#endif
@@ -44,6 +44,8 @@
 
 #include <sferes/eval/parallel.hpp>
 #include <sferes/dbg/dbg.hpp>
+#include <sferes/misc/stat_format.hpp>
+#include <sferes/misc/async_writer.hpp>
 
 namespace sferes {
 
@@ -70,7 +72,9 @@ namespace sferes {
     ("stat,s", po::value<int>(), "statistic number")
     ("out,o", po::value<std::string>(), "output file")
     ("number,n", po::value<int>(), "number in stat")
-    ("load,l", po::value<std::string>(), "load a result file")
+    ("load,l", po::value<std::string>(), "load a result file (xml or binary)")
+    ("format,f", po::value<std::string>(),
+     "format of the generation files: xml (default, portable), binary or gz")
     ("verbose,v", po::value<std::vector<std::string> >()->multitoken(),
      "verbose output, available default streams : all, ea, fit, phen, trace")
     ;
@@ -108,6 +112,9 @@ namespace sferes {
         attach_ostream(dbg::tracing, std::cout);
     }
 
+    if (vm.count("format"))
+      ea.set_format(misc::stat_format(vm["format"].as<std::string>()));
+
     parallel::init();
     if (vm.count("load")) {
       ea.load(vm["load"].as<std::string>());
@@ -125,8 +132,11 @@ namespace sferes {
         std::ofstream ofs(vm["out"].as<std::string>().c_str());
         ea.show_stat(stat, ofs, n);
       }
-    } else
+    } else {
+      // SIGINT/SIGTERM end the run cleanly (see Ea::run)
+      misc::catch_interrupt();
       ea.run();
+    }
   }
 
   template<typename Ea>
@@ -0,0 +1,158 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+#ifndef NO_PARALLEL
+#define NO_PARALLEL
+#endif
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE bipop_cmaes
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <iostream>
+#include <Eigen/Core>
+
+#include <sferes/phen/parameters.hpp>
+#include <sferes/gen/float.hpp>
+#include <sferes/ea/bipop_cmaes.hpp>
+#include <sferes/eval/eval.hpp>
+#include <sferes/stat/best_fit.hpp>
+#include <sferes/eval/parallel.hpp>
+#include <sferes/modif/dummy.hpp>
+
+using namespace sferes;
+
+
+struct Params {
+  struct pop {
+    SFERES_CONST size_t size = 1;//not used by CMAES
+    SFERES_CONST unsigned nb_gen = 650;
+    SFERES_CONST int dump_period = -1;
+  };
+  struct cmaes {
+    SFERES_CONST size_t nb_instances = 4;
+    SFERES_CONST ea::cmaes_restart::restart_t restart = ea::cmaes_restart::bipop;
+    SFERES_CONST float sigma = 0.5f;
+  };
+
+  struct parameters {
+    SFERES_CONST float min = 0.0f;
+    SFERES_CONST float max = 1.0f;
+  };
+};
+
+float felli(const std::vector<float>& xx) {
+  Eigen::VectorXf x = Eigen::VectorXf::Zero(xx.size());
+  for (size_t i = 0; i < xx.size(); ++i)
+    x[i] = xx[i];
+  Eigen::VectorXf v = Eigen::VectorXf::Zero(x.size());
+  for (size_t i = 0; i < v.size(); ++i)
+    v[i] = powf(1e6, i / (x.size() - 1.0f));
+  return v.dot((x.array() * x.array()).matrix());
+}
+
+SFERES_FITNESS(FitElli, sferes::fit::Fitness) {
+public:
+  FitElli() {}
+  template<typename Indiv>
+  void eval(Indiv& ind) {
+    this->_value = -felli(ind.data());
+  }
+};
+
+
+struct ParamsIpop : public Params {
+  struct cmaes {
+    SFERES_CONST size_t nb_instances = 2;
+    SFERES_CONST ea::cmaes_restart::restart_t restart = ea::cmaes_restart::ipop;
+    SFERES_CONST float sigma = 0.5f;
+  };
+};
+
+// shifted Rastrigin: many local optima, restarts are needed
+float frastrigin(const std::vector<float>& xx) {
+  float f = 10.0f * xx.size();
+  for (size_t i = 0; i < xx.size(); ++i) {
+    float x = (xx[i] - 0.5f) * 10.24f;
+    f += x * x - 10.0f * cosf(2 * M_PI * x);
+  }
+  return f;
+}
+
+SFERES_FITNESS(FitRastrigin, sferes::fit::Fitness) {
+public:
+  template<typename Indiv>
+  void eval(Indiv& ind) {
+    this->_value = -frastrigin(ind.data());
+  }
+};
+
+BOOST_AUTO_TEST_CASE(test_bipop_cmaes) {
+  srand(time(0));
+  typedef gen::Float<10, Params> gen_t;
+  typedef phen::Parameters<gen_t, FitElli<Params>, Params> phen_t;
+  typedef eval::Parallel<Params> eval_t;
+  typedef boost::fusion::vector<stat::BestFit<phen_t, Params> >  stat_t;
+  typedef modif::Dummy<> modifier_t;
+  typedef ea::BipopCmaes<phen_t, eval_t, stat_t, modifier_t, Params> ea_t;
+  ea_t ea;
+
+  ea.run();
+  float best = ea.best()->fit().value();
+  std::cout<<"best fit (bipop cmaes):"<<best<<" restarts:"<<ea.nb_restarts()<<std::endl;
+  BOOST_CHECK(best > -1e-3);
+  size_t lambda = 0;
+  for (size_t k = 0; k < Params::cmaes::nb_instances; ++k)
+    lambda += ea.lambda(k);
+  BOOST_CHECK_EQUAL(lambda, ea.pop().size());
+}
+
+BOOST_AUTO_TEST_CASE(test_ipop_cmaes) {
+  // fixed seed: a single long run without restart is possible (but rare)
+  srand(1);
+  typedef gen::Float<5, ParamsIpop> gen_t;
+  typedef phen::Parameters<gen_t, FitRastrigin<ParamsIpop>, ParamsIpop> phen_t;
+  typedef eval::Parallel<ParamsIpop> eval_t;
+  typedef boost::fusion::vector<stat::BestFit<phen_t, ParamsIpop> >  stat_t;
+  typedef modif::Dummy<> modifier_t;
+  typedef ea::BipopCmaes<phen_t, eval_t, stat_t, modifier_t, ParamsIpop> ea_t;
+  ea_t ea;
+
+  ea.run();
+  float best = ea.best()->fit().value();
+  std::cout<<"best fit (ipop cmaes):"<<best<<" restarts:"<<ea.nb_restarts()<<std::endl;
+  BOOST_CHECK(ea.nb_restarts() > 0);
+  BOOST_CHECK(best > -5.0f);
+}
@@ -0,0 +1,181 @@
+//| This file is a part of the sferes2 framework.
+//| Copyright 2009, ISIR / Universite Pierre et Marie Curie (UPMC)
+//| Main contributor(s): Jean-Baptiste Mouret, mouret@isir.fr
+//|
+//| This software is a computer program whose purpose is to facilitate
+//| experiments in evolutionary computation and evolutionary robotics.
+//|
+//| This software is governed by the CeCILL license under French law
+//| and abiding by the rules of distribution of free software.  You
+//| can use, modify and/ or redistribute the software under the terms
+//| of the CeCILL license as circulated by CEA, CNRS and INRIA at the
+//| following URL "http://www.cecill.info".
+//|
+//| As a counterpart to the access to the source code and rights to
+//| copy, modify and redistribute granted by the license, users are
+//| provided only with a limited warranty and the software's author,
+//| the holder of the economic rights, and the successive licensors
+//| have only limited liability.
+//|
+//| In this respect, the user's attention is drawn to the risks
+//| associated with loading, using, modifying and/or developing or
+//| reproducing the software by the user in light of its specific
+//| status of free software, that may mean that it is complicated to
+//| manipulate, and that also therefore means that it is reserved for
+//| developers and experienced professionals having in-depth computer
+//| knowledge. Users are therefore encouraged to load and test the
+//| software's suitability as regards their requirements in conditions
+//| enabling the security of their systems and/or data to be ensured
+//| and, more generally, to use and operate it in the same conditions
+//| as regards security.
+//|
+//| The fact that you are presently reading this means that you have
+//| had knowledge of the CeCILL license and that you accept its terms.
+
+
+
+
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE parallel_scenarios
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <sferes/phen/parameters.hpp>
+#include <sferes/gen/evo_float.hpp>
+#include <sferes/ea/rank_simple.hpp>
+#include <sferes/eval/eval.hpp>
+#include <sferes/stat/best_fit.hpp>
+#include <sferes/stat/mean_fit.hpp>
+#include <sferes/modif/dummy.hpp>
+
+#include <sferes/eval/parallel_scenarios.hpp>
+#include <sferes/eval/parallel_batches.hpp>
+
+using namespace sferes;
+using namespace sferes::gen::evo_float;
+
+struct Params {
+  struct evo_float {
+    SFERES_CONST float cross_rate = 0.5f;
+    SFERES_CONST float mutation_rate = 0.1f;
+    SFERES_CONST float eta_m = 15.0f;
+    SFERES_CONST float eta_c = 10.0f;
+    SFERES_CONST mutation_t mutation_type = polynomial;
+    SFERES_CONST cross_over_t cross_over_type = sbx;
+  };
+  struct pop {
+    SFERES_CONST unsigned size = 100;
+    SFERES_CONST unsigned nb_gen = 200;
+    SFERES_CONST int dump_period = -1;
+    SFERES_CONST int initial_aleat = 1;
+    SFERES_CONST float coeff = 1.1f;
+    SFERES_CONST float keep_rate = 0.6f;
+  };
+  struct parameters {
+    SFERES_CONST float min = -10.0f;
+    SFERES_CONST float max = 10.0f;
+  };
+  // ParallelBatches
+  struct eval {
+    // does not divide the population size
+    SFERES_CONST size_t batch_size = 7;
+  };
+};
+
+// worst of 3 shifted spheres; the scenarios can be evaluated one by one
+// (ParallelScenarios) or for a batch of individuals (ParallelBatches)
+SFERES_FITNESS(FitScenarios, sferes::fit::Fitness) {
+public:
+  SFERES_CONST size_t nb = 3;
+  size_t nb_scenarios() const {
+    return nb;
+  }
+  template<typename Indiv>
+  void eval_scenario(Indiv& ind, size_t s) {
+    float v = 0;
+    for (unsigned i = 0; i < ind.size(); ++i) {
+      float p = ind.data(i) - s;
+      v += p * p;
+    }
+    _scenarios[s] = -v;
+    ++_nb_evals[s];
+  }
+  template<typename Phen>
+  static void eval_batch(std::vector<boost::shared_ptr<Phen> >& pop,
+                         size_t begin, size_t end, size_t s) {
+    for (size_t i = begin; i < end; ++i)
+      pop[i]->fit().eval_scenario(*pop[i], s);
+  }
+  void reduce() {
+    this->_value = *std::min_element(_scenarios, _scenarios + nb);
+  }
+  template<typename Indiv>
+  void eval(Indiv& ind) {
+    for (size_t s = 0; s < nb; ++s)
+      eval_scenario(ind, s);
+    reduce();
+  }
+  // number of evaluations of scenario s since the last reset()
+  size_t nb_evals(size_t s) const {
+    return _nb_evals[s];
+  }
+  void reset() {
+    std::fill(_nb_evals, _nb_evals + nb, 0);
+  }
+  FitScenarios() {
+    reset();
+  }
+protected:
+  float _scenarios[nb];
+  size_t _nb_evals[nb];
+};
+
+typedef gen::EvoFloat<10, Params> gen_t;
+typedef phen::Parameters<gen_t, FitScenarios<Params>, Params> phen_t;
+
+// every scenario of every individual of [begin, end) is evaluated exactly
+// once, and gives the same values as the sequential evaluation; then the
+// evaluator is used in an EA
+template<typename Eval>
+void check_eval() {
+  typedef boost::fusion::vector<stat::BestFit<phen_t, Params>, stat::MeanFit<Params> >  stat_t;
+  typedef modif::Dummy<> modifier_t;
+  typedef ea::RankSimple<phen_t, Eval, stat_t, modifier_t, Params> ea_t;
+
+  // both evaluators see the same individuals and the same EA run
+  srand(1);
+  std::vector<boost::shared_ptr<phen_t> > pop;
+  for (size_t i = 0; i < 30; ++i) {
+    pop.push_back(boost::shared_ptr<phen_t>(new phen_t()));
+    pop.back()->random();
+  }
+  Eval().eval(pop, 3, 27, FitScenarios<Params>());
+  for (size_t i = 3; i < 27; ++i) {
+    for (size_t s = 0; s < FitScenarios<Params>::nb; ++s)
+      BOOST_CHECK_EQUAL(pop[i]->fit().nb_evals(s), 1u);
+    float v = pop[i]->fit().value();
+    pop[i]->fit().eval(*pop[i]);
+    BOOST_CHECK_CLOSE(v, pop[i]->fit().value(), 1e-4);
+  }
+  for (size_t s = 0; s < FitScenarios<Params>::nb; ++s) {
+    BOOST_CHECK_EQUAL(pop[0]->fit().nb_evals(s), 0u);
+    BOOST_CHECK_EQUAL(pop[29]->fit().nb_evals(s), 0u);
+  }
+
+  ea_t ea;
+  ea.run();
+  std::cout<<"==> best fitness ="<<ea.template stat<0>().best()->fit().value()<<std::endl;
+  // optimum: all parameters at 1, fitness -10
+  BOOST_CHECK(ea.template stat<0>().best()->fit().value() > -11);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_scenarios) {
+  check_eval<eval::ParallelScenarios<Params> >();
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_batches) {
+  check_eval<eval::ParallelBatches<Params> >();
+}
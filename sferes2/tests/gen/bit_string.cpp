@@ -87,6 +87,57 @@ BOOST_AUTO_TEST_CASE(bitstring) {
 
 }
 
+struct Params3 {
+  struct bit_string {
+    SFERES_CONST size_t nb_bits = 8;
+    SFERES_CONST float mutation_rate = 1.0f;
+    SFERES_CONST float mutation_rate_bit = 0.1f;
+  };
+};
+
+// values across two 64-bit words
+BOOST_AUTO_TEST_CASE(bitstring_packed) {
+  BitString<10, Params2> gen;
+  gen.random();
+  for (size_t i = 0; i < gen.size(); ++i) {
+    std::bitset<50> b = gen.bs_data(i);
+    double x = 0;
+    for (size_t j = 0; j < b.size(); ++j)
+      x += b[j] * pow(2.0, j);
+    BOOST_CHECK_CLOSE(gen.data(i), x / (pow(2.0, 50) - 1), 0.0001);
+    BOOST_CHECK_EQUAL(gen.int_data(i), b.to_ulong());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(bitstring_cross) {
+  BitString<10, Params2> gen1, gen2, gen3, gen4;
+  gen1.random();
+  gen2.random();
+  gen1.cross(gen2, gen3, gen4);
+  // each bit of a child comes from one parent, the other child has the
+  // bit of the other parent
+  for (size_t i = 0; i < gen1.size(); ++i) {
+    std::bitset<50> b1 = gen1.bs_data(i), b2 = gen2.bs_data(i);
+    std::bitset<50> b3 = gen3.bs_data(i), b4 = gen4.bs_data(i);
+    for (size_t j = 0; j < b1.size(); ++j)
+      BOOST_CHECK((b3[j] == b1[j] && b4[j] == b2[j])
+                  || (b3[j] == b2[j] && b4[j] == b1[j]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(bitstring_mutate) {
+  BitString<1000, Params3> gen1;
+  gen1.random();
+  BitString<1000, Params3> gen2 = gen1;
+  gen2.mutate();
+  size_t nb_flips = 0;
+  for (size_t i = 0; i < gen1.size(); ++i)
+    nb_flips += (gen1.bs_data(i) ^ gen2.bs_data(i)).count();
+  // 800 on average
+  BOOST_CHECK(nb_flips > 650);
+  BOOST_CHECK(nb_flips < 950);
+}
+
 struct check_bitstring_eq {
   template<typename T>
   void operator()(const T& gen1, const T& gen2) const {